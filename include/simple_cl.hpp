@@ -25,6 +25,23 @@
 #include <cstdint>
 #include <cassert>
 #include <array>
+#include <cstring>
+#include <stdexcept>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <cstdio>
+#include <thread>
+#include <typeinfo>
+#include <typeindex>
+#include <random>
+#include <functional>
+#include <condition_variable>
+#include <deque>
 
 /**
 *	\namespace simple_cl
@@ -81,7 +98,7 @@ namespace simple_cl
 		*	\tparam ...	List of predicates.
 		*/
 		template <typename...>
-		struct conjunction : std::false_type {};
+		struct conjunction : std::true_type {}; // empty list, like std::conjunction<>
 		/**
 		*	\brief Conjunction of boolean predicates.
 		*
@@ -201,6 +218,43 @@ namespace simple_cl
 		*/
 		unsigned int get_cl_version_num(const std::string& str);
 
+		/// Offset basis of the 64 bit FNV-1a hash.
+		constexpr std::uint64_t FNV1A_64_OFFSET_BASIS{14695981039346656037ull};
+		/// Prime of the 64 bit FNV-1a hash.
+		constexpr std::uint64_t FNV1A_64_PRIME{1099511628211ull};
+		/**
+			* \brief Computes the 64 bit FNV-1a hash of a byte range.
+			* \param data	Pointer to the first byte.
+			* \param length	Number of bytes.
+			* \param hash	Hash to continue from. Allows hashing several ranges as if they were concatenated.
+			* \return Returns the hash value.
+		*/
+		std::uint64_t fnv1a_64(const void* data, std::size_t length, std::uint64_t hash = FNV1A_64_OFFSET_BASIS);
+
+		/**
+			* \brief Returns a suffix for temporary file names which is unique across processes and calls.
+			*
+			* Combines a random value drawn once per process with a per process counter. Used to write cache files
+			* to a temporary file before renaming them into place, so concurrent writers never share a temporary file.
+			* \return Returns the suffix.
+		*/
+		std::string unique_temp_suffix();
+		/**
+			* \brief Computes the 64 bit FNV-1a hash of a zero terminated string at compile time. Yields the same value as fnv1a_64() over the characters.
+			* \param str	Zero terminated string.
+			* \param hash	Hash to continue from.
+			* \return Returns the hash value.
+		*/
+		constexpr std::uint64_t fnv1a_64_cstr(const char* str, std::uint64_t hash = FNV1A_64_OFFSET_BASIS)
+		{
+			return *str ? fnv1a_64_cstr(str + 1, (hash ^ std::uint64_t{static_cast<unsigned char>(*str)}) * FNV1A_64_PRIME) : hash;
+		}
+		/// Returns the length of a zero terminated string at compile time.
+		constexpr std::size_t cstr_length(const char* str, std::size_t length = 0ull)
+		{
+			return *str ? cstr_length(str + 1, length + 1ull) : length;
+		}
+
 		// memory alignment stuff
 		/**
 		*	\brief Returns a size greater than or equal to 'size' which is a multiple of 'alignment'.
@@ -249,7 +303,7 @@ namespace simple_cl
 				n = n >> 1;
 				++ct;
 			}
-			return std::size_t{1ull >> (ct + 1)};
+			return std::size_t{1ull} << ct;
 		}
 	}
 
@@ -267,12 +321,154 @@ namespace simple_cl
 			constexpr std::size_t OCL_MAX_FILL_COLOR_BYTES{4 * sizeof(float)};
 			/// Invalid color channel index
 			constexpr std::size_t INVALID_COLOR_CHANNEL_INDEX{0xDEADBEEF};
+			/// Number of dependency events stored without heap allocation, see EventList.
+			constexpr std::size_t EVENT_LIST_INLINE_CAPACITY{16};
+			/// Size class index of BufferPool allocations with a dedicated buffer.
+			constexpr std::size_t BUFFER_POOL_OVERSIZE{std::numeric_limits<std::size_t>::max()};
 		}
 
 		#pragma region context
 		/// Callback function used during OpenCL context creation.
 		void create_context_callback(const char* errinfo, const void* private_info, std::size_t cb, void* user_data);
 
+		/**
+			* \brief	Specifies which kinds of OpenCL devices are considered during platform and device enumeration.
+		*/
+		enum class DeviceType : cl_device_type
+		{
+			GPU = CL_DEVICE_TYPE_GPU,					///< Graphics processors.
+			CPU = CL_DEVICE_TYPE_CPU,					///< Host processors, e.g. exposed by pocl or vendor CPU runtimes.
+			Accelerator = CL_DEVICE_TYPE_ACCELERATOR,	///< Dedicated accelerators like FPGAs or DSPs.
+			All = CL_DEVICE_TYPE_ALL					///< Every device type.
+		};
+
+		/**
+			* \brief	Declares what matters for a workload. Used to rank devices for automatic device selection.
+			*
+			*	Each device property is normalized to the best value among all candidate devices before weighting, so the weights express
+			*	relative importance only. If probe is true, a short copy kernel (bandwidth) and a short multiply-add kernel (arithmetic
+			*	throughput) are run on every candidate. This takes some hundred milliseconds per device but reflects clock rates and
+			*	memory technology, which the static device properties do not.
+		*/
+		struct WorkloadProfile
+		{
+			double compute_units_weight;		///< Weight of CLDevice::max_compute_units.
+			double global_mem_size_weight;		///< Weight of CLDevice::global_mem_size.
+			double local_mem_size_weight;		///< Weight of CLDevice::local_mem_size.
+			double work_group_size_weight;		///< Weight of CLDevice::max_work_group_size.
+			bool probe;							///< If true, runs the micro-probes on every candidate device.
+			double probe_bandwidth_weight;		///< Weight of the measured global memory bandwidth. Ignored if probe is false.
+			double probe_compute_weight;		///< Weight of the measured arithmetic throughput. Ignored if probe is false.
+
+			/// Profile for arithmetically intensive workloads.
+			static WorkloadProfile compute_bound(bool probe = false) { return WorkloadProfile{1.0, 0.1, 0.2, 0.2, probe, 0.2, 1.0}; }
+			/// Profile for workloads limited by global memory size and bandwidth.
+			static WorkloadProfile memory_bound(bool probe = false) { return WorkloadProfile{0.3, 1.0, 0.1, 0.1, probe, 1.0, 0.2}; }
+			/// Profile weighting all properties equally.
+			static WorkloadProfile balanced(bool probe = false) { return WorkloadProfile{1.0, 1.0, 1.0, 1.0, probe, 1.0, 1.0}; }
+		};
+
+		/**
+			* \brief	Describes how a device is partitioned into sub-devices (see clCreateSubDevices).
+			*
+			*	Use the factory functions equally(...), by_counts(...) or by_affinity_domain(...) to create a partition description.
+			*	E.g. DevicePartition::by_affinity_domain(DevicePartition::AffinityDomain::NUMA) creates one sub-device per NUMA node of a CPU device.
+		*/
+		struct DevicePartition
+		{
+			/// Partitioning scheme.
+			enum class Scheme : cl_device_partition_property
+			{
+				Equally = CL_DEVICE_PARTITION_EQUALLY,						///< As many sub-devices as possible with the same number of compute units each.
+				ByCounts = CL_DEVICE_PARTITION_BY_COUNTS,					///< One sub-device per entry of compute_unit_counts.
+				ByAffinityDomain = CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN	///< One sub-device per affinity domain (NUMA node, shared cache) of the device.
+			};
+
+			/// Affinity domains used by Scheme::ByAffinityDomain.
+			enum class AffinityDomain : cl_device_affinity_domain
+			{
+				NUMA = CL_DEVICE_AFFINITY_DOMAIN_NUMA,								///< Compute units sharing a NUMA node.
+				L4Cache = CL_DEVICE_AFFINITY_DOMAIN_L4_CACHE,						///< Compute units sharing a level 4 cache.
+				L3Cache = CL_DEVICE_AFFINITY_DOMAIN_L3_CACHE,						///< Compute units sharing a level 3 cache.
+				L2Cache = CL_DEVICE_AFFINITY_DOMAIN_L2_CACHE,						///< Compute units sharing a level 2 cache.
+				L1Cache = CL_DEVICE_AFFINITY_DOMAIN_L1_CACHE,						///< Compute units sharing a level 1 cache.
+				NextPartitionable = CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE	///< The first of the above domains (from NUMA downwards) the device can be partitioned along.
+			};
+
+			/// Partition into sub-devices with compute_units_per_sub_device compute units each.
+			static DevicePartition equally(unsigned int compute_units_per_sub_device) { return DevicePartition{Scheme::Equally, compute_units_per_sub_device, {}, AffinityDomain::NUMA}; }
+			/// Partition into one sub-device per entry with the given number of compute units.
+			static DevicePartition by_counts(const std::vector<unsigned int>& compute_unit_counts) { return DevicePartition{Scheme::ByCounts, 0u, compute_unit_counts, AffinityDomain::NUMA}; }
+			/// Partition along the given affinity domain.
+			static DevicePartition by_affinity_domain(AffinityDomain domain = AffinityDomain::NUMA) { return DevicePartition{Scheme::ByAffinityDomain, 0u, {}, domain}; }
+
+			Scheme scheme;									///< Partitioning scheme.
+			unsigned int compute_units;						///< Compute units per sub-device. Used by Scheme::Equally only.
+			std::vector<unsigned int> compute_unit_counts;	///< Compute units of each sub-device. Used by Scheme::ByCounts only.
+			AffinityDomain affinity_domain;					///< Affinity domain to partition along. Used by Scheme::ByAffinityDomain only.
+		};
+
+		/**
+			* \brief	Specifies properties of command queues, see Context::create_queue(...) and the queue_properties parameter of the Context factories.
+		*/
+		enum class QueueProperties : cl_command_queue_properties
+		{
+			None = cl_command_queue_properties{0ull},				///< In-order queue. Commands execute in the order they were enqueued.
+			OutOfOrder = CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE,	///< Commands may execute in any order. Ordering has to be expressed via Event dependencies.
+			Profiling = CL_QUEUE_PROFILING_ENABLE					///< Records device timestamps for every command, see Event::profiling_info().
+		};
+
+		/// Combines two sets of queue properties.
+		constexpr QueueProperties operator|(QueueProperties lhs, QueueProperties rhs)
+		{
+			return static_cast<QueueProperties>(static_cast<cl_command_queue_properties>(lhs) | static_cast<cl_command_queue_properties>(rhs));
+		}
+
+		/**
+			*	\brief Non owning handle to a command queue of a Context.
+			*
+			*	Every read, write, fill and kernel invoke can be directed to a Queue. A Queue is implicitly constructible from a context device index
+			*	and then refers to the default in-order queue of that device. Additional in-order or out-of-order queues are created with
+			*	Context::create_queue(...), e.g. to overlap uploads for the next batch with kernels running on the current one.
+			*
+			*	\attention The handle becomes invalid if the creating Context dies.
+		*/
+		class Queue
+		{
+		public:
+			/// Refers to the default queue of the device with the given context device index.
+			Queue(std::size_t device_index = 0ull) noexcept : m_device_index{device_index}, m_queue{nullptr}, m_events_enabled{true} {}
+
+			/// Returns the context device index of the device this queue executes on.
+			std::size_t device_index() const noexcept { return m_device_index; }
+			/// Returns true if this handle refers to the default queue of its device.
+			bool is_default() const noexcept { return m_queue == nullptr; }
+
+			/**
+			*	\brief Returns a handle to the same queue which submits commands without creating events ("fire and forget").
+			*
+			*	Commands submitted through the returned handle pass nullptr as event output to OpenCL and return an empty Event.
+			*	This saves the creation and release of a cl_event per command in tight submission loops. Waiting on an empty Event
+			*	returns immediately and empty events are skipped in dependency lists, so completion has to be established otherwise:
+			*	by the order of an in-order queue, by Context::finish(queue) or by a later command which returns an event.
+			*/
+			Queue without_events() const noexcept { Queue queue{*this}; queue.m_events_enabled = false; return queue; }
+			/// Returns false if commands submitted through this handle do not create events.
+			bool events_enabled() const noexcept { return m_events_enabled; }
+
+		private:
+			friend class Context;
+			Queue(std::size_t device_index, cl_command_queue queue) noexcept : m_device_index{device_index}, m_queue{queue}, m_events_enabled{true} {}
+
+			std::size_t m_device_index;	///< Context device index.
+			cl_command_queue m_queue;	///< Native queue handle, nullptr for the default queue of the device.
+			bool m_events_enabled;		///< False if commands are submitted without creating events.
+		};
+
+		class Program;
+		class Event;
+		class EventList;
+
 		/**
 			*	\brief Creates and manages OpenCL platform, device, context and command queue
 			*
@@ -290,6 +486,8 @@ namespace simple_cl
 			struct CLDevice
 			{
 				cl_device_id device_id;							///< OpenCL device id.
+				cl_device_type device_type;						///< Type of the device (bit field of CL_DEVICE_TYPE_* values).
+				cl_command_queue_properties queue_properties;	///< Command queue properties supported by the device.
 				cl_uint vendor_id;								///< Vendor id.
 				cl_uint max_compute_units;						///< Maximum number of compute units on this device.
 				cl_uint max_work_item_dimensions;				///< Maximum dimensions of work items. OpenCL compliant GPU's have to provide at least 3.
@@ -321,6 +519,9 @@ namespace simple_cl
 				unsigned int device_version_num;				///< Parsed version of the above. 120 => OpenCL 1.2, 200 => OpenCL 2.0...
 				std::string device_extensions;					///< Comma-separated list of available extensions supported by this device.
 				std::size_t printf_buffer_size;					///< Maximum number of characters printable from a kernel.
+				cl_device_id parent_device_id;					///< Parent device if this is a sub-device, nullptr for root devices.
+				cl_uint partition_max_sub_devices;				///< Maximum number of sub-devices this device can be partitioned into. 0 if the device cannot be partitioned.
+				cl_device_affinity_domain partition_affinity_domains;	///< Bit field of affinity domains supported for partitioning.
 			};
 				
 			/**
@@ -339,6 +540,19 @@ namespace simple_cl
 				std::vector<CLDevice> devices;		///< List of available OpenCL 1.2+ devices on this platform.
 			};
 
+			/**
+				*	\struct	DeviceScore
+				*	\brief	Result of ranking a device against a WorkloadProfile.
+			*/
+			struct DeviceScore
+			{
+				std::size_t platform_index;		///< Platform index in the list returned by read_platform_and_device_info() for the ranked device type.
+				std::size_t device_index;		///< Device index within that platform.
+				double score;					///< Weighted score. Higher is better.
+				double probe_bandwidth;			///< Measured global memory bandwidth in bytes per second, 0 if not probed.
+				double probe_flops;				///< Measured single precision arithmetic throughput in FLOP per second, 0 if not probed.
+			};
+
 			/**
 				* \brief This factory function creates a new instance of Context and returns a std::shared_ptr<Context> to this instance.
 				*
@@ -347,9 +561,99 @@ namespace simple_cl
 				* 
 				*	\param platform_index	Index of the platform to create the context from.
 				*	\param device_index		Index of the device in the selected platform to create the context for.
+				*	\param device_type		Kind of devices to enumerate. Platform and device indices refer to the list filtered by this type.
+				*	\param queue_properties	Properties of the default command queues, e.g. QueueProperties::Profiling.
 				*	\return					A shared pointer to the newly created Context instance. Use this for instantiating the other wrapper classes.
 			*/
-			static std::shared_ptr<Context> createInstance(std::size_t platform_index, std::size_t device_index);
+			static std::shared_ptr<Context> createInstance(std::size_t platform_index, std::size_t device_index, DeviceType device_type = DeviceType::GPU, QueueProperties queue_properties = QueueProperties::None);
+
+			/**
+				* \brief This factory function creates a new Context for the first suitable device matching a list of preferred device types.
+				*
+				*	The device types are tried in the given order. For each type, the first suitable device of the first platform providing one is selected.
+				*	E.g. {DeviceType::GPU, DeviceType::CPU} prefers GPUs but falls back to a CPU runtime on machines without GPU.
+				*
+				*	\param device_type_preference	Device types in order of preference.
+				*	\param queue_properties	Properties of the default command queues, e.g. QueueProperties::Profiling.
+				*	\return							A shared pointer to the newly created Context instance.
+			*/
+			static std::shared_ptr<Context> createInstance(const std::vector<DeviceType>& device_type_preference, QueueProperties queue_properties = QueueProperties::None);
+
+			/**
+				* \brief This factory function creates a new Context for the device ranked best for the given workload profile.
+				*
+				*	Avoids hard-coded platform and device indices which differ between machines and driver versions. See rank_devices(...).
+				*
+				*	\param profile		Workload profile to rank the devices by.
+				*	\param device_type	Kind of devices to consider.
+				*	\param queue_properties	Properties of the default command queues, e.g. QueueProperties::Profiling.
+				*	\return				A shared pointer to the newly created Context instance.
+			*/
+			static std::shared_ptr<Context> createInstance(const WorkloadProfile& profile, DeviceType device_type = DeviceType::All, QueueProperties queue_properties = QueueProperties::None);
+
+			/**
+				* \brief Ranks all suitable devices of the given type by a weighted score.
+				*
+				*	If the profile enables probing, a temporary context is created for every candidate device to run the micro-probes.
+				*	These contexts don't print the initialization banner.
+				*
+				*	\param profile		Workload profile to rank the devices by.
+				*	\param device_type	Kind of devices to consider.
+				*	\return				Scores of all candidate devices, best first.
+			*/
+			static std::vector<DeviceScore> rank_devices(const WorkloadProfile& profile, DeviceType device_type = DeviceType::All);
+
+			/**
+				* \brief This factory function creates a new Context spanning several devices of one platform.
+				*
+				*	One command queue is created per device. Programs are built for all devices of the context and memory objects are shared between them.
+				*	Devices are addressed by their position in device_indices ("context device index") in all other member functions and wrapper classes.
+				*
+				*	\param platform_index	Index of the platform to create the context from.
+				*	\param device_indices	Indices of the devices in the selected platform to create the context for.
+				*	\param device_type		Kind of devices to enumerate. Platform and device indices refer to the list filtered by this type.
+				*	\param queue_properties	Properties of the default command queues, e.g. QueueProperties::Profiling.
+				*	\return					A shared pointer to the newly created Context instance.
+			*/
+			static std::shared_ptr<Context> createInstance(std::size_t platform_index, const std::vector<std::size_t>& device_indices, DeviceType device_type = DeviceType::GPU, QueueProperties queue_properties = QueueProperties::None);
+
+			/**
+				* \brief This factory function creates a new Context spanning every suitable device of the given type on one platform.
+				*	\param platform_index	Index of the platform to create the context from.
+				*	\param device_type		Kind of devices to use.
+				*	\param queue_properties	Properties of the default command queues, e.g. QueueProperties::Profiling.
+				*	\return					A shared pointer to the newly created Context instance.
+			*/
+			static std::shared_ptr<Context> createPlatformInstance(std::size_t platform_index, DeviceType device_type = DeviceType::GPU, QueueProperties queue_properties = QueueProperties::None);
+
+			/**
+				* \brief This factory function partitions a device and creates one Context per sub-device.
+				*
+				*	Useful to pin work to e.g. one NUMA node of a multi-socket CPU device each. Every returned Context owns its sub-device
+				*	and releases it on destruction.
+				*
+				*	\param platform_index	Index of the platform of the device to partition.
+				*	\param device_index		Index of the device to partition in the selected platform.
+				*	\param partition		Partition description.
+				*	\param device_type		Kind of devices to enumerate. Platform and device indices refer to the list filtered by this type.
+				*	\param queue_properties	Properties of the default command queues, e.g. QueueProperties::Profiling.
+				*	\return					One Context per sub-device, in the order returned by clCreateSubDevices.
+			*/
+			static std::vector<std::shared_ptr<Context>> createSubDeviceInstances(std::size_t platform_index, std::size_t device_index, const DevicePartition& partition, DeviceType device_type = DeviceType::GPU, QueueProperties queue_properties = QueueProperties::None);
+
+			/**
+				* \brief This factory function partitions a device and creates a single Context spanning all sub-devices.
+				*
+				*	Each sub-device gets its own command queue and is addressed by its context device index. The Context owns the sub-devices.
+				*
+				*	\param platform_index	Index of the platform of the device to partition.
+				*	\param device_index		Index of the device to partition in the selected platform.
+				*	\param partition		Partition description.
+				*	\param device_type		Kind of devices to enumerate. Platform and device indices refer to the list filtered by this type.
+				*	\param queue_properties	Properties of the default command queues, e.g. QueueProperties::Profiling.
+				*	\return					A shared pointer to the newly created Context instance.
+			*/
+			static std::shared_ptr<Context> createSubDeviceInstance(std::size_t platform_index, std::size_t device_index, const DevicePartition& partition, DeviceType device_type = DeviceType::GPU, QueueProperties queue_properties = QueueProperties::None);
 
 			/// Destructor.
 			~Context();
@@ -360,10 +664,85 @@ namespace simple_cl
 			*/
 			cl_context context() const { return m_context; }
 			/**
-				* \brief	Returns the native OpenCL handle to the command queue.
+				* \brief	Returns the native OpenCL handle to a command queue.
+				* \param	queue	Queue handle or context device index. A device index refers to the default queue of that device.
 				* \return  Returns the native OpenCL handle to the command queue.
 			*/
-			cl_command_queue command_queue() const { return m_command_queue; }
+			cl_command_queue command_queue(const Queue& queue = Queue{}) const
+			{
+				if(queue.m_device_index >= m_command_queues.size())
+					throw std::out_of_range("[Context]: Device index out of range.");
+				return queue.m_queue ? queue.m_queue : m_command_queues[queue.m_device_index];
+			}
+
+			/**
+				* \brief	Creates an additional command queue for a device.
+				*
+				*	Commands enqueued to different queues may overlap. The queue is owned by the context and lives as long as the context does.
+				*	Thread-safe, several threads may create queues on the same context concurrently.
+				*
+				* \param	device_index	Context device index of the device the queue executes on.
+				* \param	properties		Queue properties. Throws if the device does not support them.
+				* \return	Returns a handle to the new queue.
+			*/
+			Queue create_queue(std::size_t device_index = 0ull, QueueProperties properties = QueueProperties::None);
+
+			/**
+				* \brief	Issues all previously enqueued commands of a queue to the device.
+				* \param	queue	Queue handle or context device index.
+			*/
+			void flush(const Queue& queue = Queue{}) const;
+
+			/**
+				* \brief	Blocks until all previously enqueued commands of a queue have completed.
+				* \param	queue	Queue handle or context device index.
+			*/
+			void finish(const Queue& queue = Queue{}) const;
+
+			/**
+				* \brief	Enqueues a marker which completes once all given events have completed. Does not block.
+				*
+				*	Collapses a large dependency fan-in into a single Event, so later commands depend on one event instead of the whole collection.
+				*	The marker always creates an event, also for queues returned by Queue::without_events().
+				* \tparam	DepIterator	Input iterator to iterate over a collection of Event's.
+				* \param	dep_begin	Begin iterator of the event collection. If the collection is empty, the marker waits for all previously enqueued commands of the queue.
+				* \param	dep_end		End iterator of the event collection.
+				* \param	queue		Queue handle or context device index.
+				* \return	Returns the marker event.
+			*/
+			template <typename DepIterator>
+			Event enqueue_marker(DepIterator dep_begin, DepIterator dep_end, const Queue& queue = Queue{}) const;
+			/**
+				* \brief	Enqueues a marker which completes once all previously enqueued commands of the queue have completed. Does not block.
+				* \param	queue	Queue handle or context device index.
+				* \return	Returns the marker event.
+			*/
+			Event enqueue_marker(const Queue& queue = Queue{}) const;
+
+			/**
+				* \brief	Enqueues a barrier: commands enqueued afterwards to the same queue do not start before all given events have completed. Does not block.
+				*
+				*	Useful for out-of-order queues, where later commands then need no explicit dependencies on the collection.
+				* \tparam	DepIterator	Input iterator to iterate over a collection of Event's.
+				* \param	dep_begin	Begin iterator of the event collection. If the collection is empty, the barrier waits for all previously enqueued commands of the queue.
+				* \param	dep_end		End iterator of the event collection.
+				* \param	queue		Queue handle or context device index.
+				* \return	Returns the barrier event, an empty event for queues returned by Queue::without_events().
+			*/
+			template <typename DepIterator>
+			Event enqueue_barrier(DepIterator dep_begin, DepIterator dep_end, const Queue& queue = Queue{}) const;
+			/**
+				* \brief	Enqueues a barrier: commands enqueued afterwards to the same queue do not start before all previously enqueued commands have completed. Does not block.
+				* \param	queue	Queue handle or context device index.
+				* \return	Returns the barrier event, an empty event for queues returned by Queue::without_events().
+			*/
+			Event enqueue_barrier(const Queue& queue = Queue{}) const;
+
+			/**
+				* \brief	Returns the number of devices this context spans.
+				* \return	Returns the number of devices (and command queues) of this context.
+			*/
+			std::size_t num_devices() const { return m_selected_devices.size(); }
 
 			/**
 				*	\brief	Returns the CLPlatform info struct of the selected platform.
@@ -372,10 +751,17 @@ namespace simple_cl
 			const CLPlatform& get_selected_platform() const;
 
 			/**
-				*	\brief	Returns the CLDevice info struct of the selected device.
+				*	\brief	Returns the CLDevice info struct of a selected device.
+				*	\param	device_index	Context device index.
 				*	\return  Returns the CLDevice info struct of the selected device.
 			*/
-			const CLDevice& get_selected_device() const;
+			const CLDevice& get_selected_device(std::size_t device_index = 0ull) const;
+
+			/**
+				*	\brief	Returns the CLDevice info structs of all devices of this context, ordered by context device index.
+				*	\return  Returns the CLDevice info structs of all selected devices.
+			*/
+			const std::vector<CLDevice>& get_selected_devices() const { return m_selected_devices; }
 
 			/**
 				*	\brief	Prints detailed information about the selected platform.
@@ -383,7 +769,7 @@ namespace simple_cl
 			void print_selected_platform_info() const;
 
 			/**
-				*	\brief	Prints detailed infomation about the selected device.
+				*	\brief	Prints detailed infomation about the selected devices.
 			*/
 			void print_selected_device_info() const;
 
@@ -399,10 +785,31 @@ namespace simple_cl
 			void print_platform_and_device_info();
 
 			/**
-				*	\brief Searches for available platforms and devices and stores suitable ones (OpenCL 1.2+) in the platforms list member.
+				*	\brief Returns the suitable (OpenCL 1.2+) platforms and devices available on the system.
+				*
+				*	Platforms and devices are enumerated once per process on first use. Later calls (and all Context factories) are served from this
+				*	snapshot. The function is thread-safe.
+				*
+				*	\param device_type	Kind of devices to return. Platforms without a suitable device of this type are omitted.
 				*	\return	Returns a vector of CLPlatform's.
 			*/
-			static std::vector<CLPlatform> read_platform_and_device_info();
+			static std::vector<CLPlatform> read_platform_and_device_info(DeviceType device_type = DeviceType::GPU);
+
+			/**
+				*	\brief Discards the process-wide platform and device snapshot. The next call to read_platform_and_device_info() enumerates again.
+			*/
+			static void refresh_platform_and_device_info();
+
+			/**
+				*	\brief Enables an on-disk cache for device information.
+				*
+				*	Devices are identified by platform name, device name and driver version, which takes only a few queries per device. All other
+				*	device information is read from the cache file if present and the file is updated with newly seen devices. A driver update therefore
+				*	invalidates the affected entries. Takes effect with the next enumeration, see refresh_platform_and_device_info().
+				*
+				*	\param path	Path of the cache file. An empty path disables the cache (default).
+			*/
+			static void set_device_info_cache_file(const std::string& path);
 
 		private:
 			/**
@@ -414,11 +821,14 @@ namespace simple_cl
 			};
 
 			/**
-				* \brief	Constructs context and command queue for the given platform and device index.
-				* \param platform_index	Selected platform index.
-				* \param device_index		Selected device index.
+				* \brief	Constructs context and command queues for the given platform and device indices.
+				* \param available_platforms	Suitable platforms and devices as received from read_platform_and_device_info().
+				* \param platform_index			Selected platform index.
+				* \param device_indices			Selected device indices.
+				* \param queue_properties		Properties of the default command queues.
+				* \param verbose				Print the initialization progress to stdout.
 			*/
-			Context(std::size_t platform_index, std::size_t device_index);
+			Context(std::vector<CLPlatform> available_platforms, std::size_t platform_index, const std::vector<std::size_t>& device_indices, QueueProperties queue_properties, bool verbose = true);
 
 			/// No copies are allowed.
 			Context(const Context&) = delete;
@@ -430,14 +840,21 @@ namespace simple_cl
 			/// Moves the entire state from one instance to another.
 			Context& operator=(Context&&) noexcept;
 
+			/// Enqueues a marker depending on a list of events. Used by enqueue_marker(...).
+			Event enqueue_marker_(const EventList& dep_events, const Queue& queue) const;
+			/// Enqueues a barrier depending on a list of events. Used by enqueue_barrier(...).
+			Event enqueue_barrier_(const EventList& dep_events, const Queue& queue) const;
+
 			/// List of available platforms which contain suitable (OpenCL 1.2+) devices.
 			std::vector<CLPlatform> m_available_platforms;
 
 			// ID's and handles for current OpenCL instance
-			std::size_t m_selected_platform_index;	///< Selected platform index for this instance.
-			std::size_t m_selected_device_index;	///< Selected device index for this instance.
-			cl_context m_context;					///< OpenCL context handle.
-			cl_command_queue m_command_queue;		///< OpenCL command queue handle.
+			std::size_t m_selected_platform_index;				///< Selected platform index for this instance.
+			std::vector<CLDevice> m_selected_devices;			///< Devices of this context, ordered by context device index.
+			cl_context m_context;								///< OpenCL context handle.
+			std::vector<cl_command_queue> m_command_queues;		///< Default OpenCL command queue handle per device.
+			std::vector<cl_command_queue> m_additional_queues;	///< Queues created via create_queue(...).
+			std::mutex m_additional_queues_mutex;				///< Guards m_additional_queues.
 
 			/**
 			* If cl error occurs which is supposed to be handled by a callback, we can't throw an exception there.
@@ -446,9 +863,24 @@ namespace simple_cl
 			*/
 			CLExHolder m_cl_ex_holder;
 
+			/**
+				* \brief Entry of the shared program registry.
+			*/
+			struct ProgramRegistryEntry
+			{
+				std::weak_ptr<Program> program;				///< Live shared program, if any.
+				std::shared_ptr<std::mutex> build_mutex;	///< Serializes builds of this entry without blocking builds of other entries.
+			};
+			/// Shared programs keyed by source hash and compiler options, see Program::getShared(...).
+			std::unordered_map<std::string, ProgramRegistryEntry> m_program_registry;
+			/// Guards m_program_registry.
+			std::mutex m_program_registry_mutex;
+
 			// --- private member functions
 
 			// friends
+			/// Program accesses the shared program registry.
+			friend class Program;
 			// global operators
 			/// Prints detailed information about the platform.
 			friend std::ostream& operator<<(std::ostream&, const Context::CLPlatform&);
@@ -459,11 +891,41 @@ namespace simple_cl
 			friend void create_context_callback(const char* errinfo, const void* private_info, std::size_t cb, void* user_data);
 
 			/**
-				* \brief Initializes OpenCL context and command queue.
+				* \brief Initializes OpenCL context and command queues.
 				* \param platform_id Selected platform index.
-				* \param device_id Selected device index.
+				* \param device_ids Selected device indices.
+				* \param queue_properties Properties of the default command queues.
+				* \param verbose Print the initialization progress to stdout.
+			*/
+			void init_cl_instance(std::size_t platform_id, const std::vector<std::size_t>& device_ids, QueueProperties queue_properties, bool verbose);
+			/**
+				* \brief Queries device information and checks whether the device is suitable (OpenCL 1.2+, image support, compiler and linker available).
+				* \param device_id	OpenCL device id.
+				* \param device	Receives the device information.
+				* \return	Returns true if the device is suitable, false otherwise.
+			*/
+			static bool read_device_info(cl_device_id device_id, CLDevice& device);
+			/**
+				* \brief Enumerates all suitable platforms and devices of all types.
+				* \param cache_file	On-disk device info cache. Ignored if empty.
+				* \return	Returns a vector of CLPlatform's.
+			*/
+			static std::vector<CLPlatform> query_platform_and_device_info(const std::string& cache_file);
+			/**
+				* \brief Runs the device selection micro-probes on a device.
+				* \param platform_index	Platform index.
+				* \param device_index	Device index within the platform.
+				* \param device_type	Device type the indices refer to.
+				* \param score			Receives the measured bandwidth and arithmetic throughput.
 			*/
-			void init_cl_instance(std::size_t platform_id, std::size_t device_id);
+			static void probe_device(std::size_t platform_index, std::size_t device_index, DeviceType device_type, DeviceScore& score);
+			/**
+				* \brief Partitions a device into sub-devices. The caller takes ownership of the sub-device ids.
+				* \param device	Device to partition.
+				* \param partition	Partition description.
+				* \return	Returns the sub-devices.
+			*/
+			static std::vector<CLDevice> create_sub_devices(const CLDevice& device, const DevicePartition& partition);
 			/**
 				* \brief Frees acquired OpenCL resources.
 			*/
@@ -566,6 +1028,21 @@ namespace simple_cl
 			typename std::enable_if<std::is_convertible<decltype(std::declval<const T>().arg_data()), const void*>::value>::type // has const arg_data() member returning something convertible to const void* ?
 		>> : std::true_type {};
 
+		/**
+		*	\brief Checks if a kernel argument type exposes a std::uint64_t arg_identity() member (may be const). Negative case.
+		*
+		*	Memory objects report a process-unique identity which is never reused. Program uses it in addition to the argument bytes
+		*	to detect changed arguments, since a new cl_mem may be allocated at the address of a released one.
+		*/
+		template <typename T, typename = void>
+		struct has_arg_identity : public std::false_type {};
+
+		/**
+		*	\brief Checks if a kernel argument type exposes a std::uint64_t arg_identity() member (may be const). Positive case.
+		*/
+		template <typename T>
+		struct has_arg_identity <T, simple_cl::meta::void_t<decltype(std::uint64_t{std::declval<const T>().arg_identity()})>> : std::true_type {};
+
 		// traits class for handling kernel arguments
 		/**
 		*	\brief Traits class for convenient processing of kernel arguments. Base template.
@@ -583,6 +1060,11 @@ namespace simple_cl
 		{
 			static std::size_t arg_size(const meta::bare_type_t<T>& arg) { return arg.arg_size(); }
 			static const void* arg_data(const meta::bare_type_t<T>& arg) { return static_cast<const void*>(arg.arg_data()); }
+			/// Returns the identity of the argument object, 0 if the type does not expose one.
+			static std::uint64_t arg_identity(const meta::bare_type_t<T>& arg) { return arg_identity_impl(arg, has_arg_identity<meta::bare_type_t<T>>{}); }
+		private:
+			static std::uint64_t arg_identity_impl(const meta::bare_type_t<T>& arg, std::true_type) { return arg.arg_identity(); }
+			static constexpr std::uint64_t arg_identity_impl(const meta::bare_type_t<T>&, std::false_type) { return 0ull; }
 		};
 
 		// case: arithmetic type or standard layout type (poc struct, plain array...)
@@ -596,8 +1078,9 @@ namespace simple_cl
 																!std::is_same<meta::bare_type_t<T>, std::nullptr_t>::value &&
 																!is_cl_param<meta::bare_type_t<T>>::value>::type>
 		{
-			static constexpr std::size_t arg_size(const meta::bare_type_t<T>& arg) { return sizeof(meta::bare_type_t<T>); }
+			static constexpr std::size_t arg_size(const meta::bare_type_t<T>&) { return sizeof(meta::bare_type_t<T>); }
 			static const void* arg_data(const meta::bare_type_t<T>& arg) { return static_cast<const void*>(&arg); }
+			static constexpr std::uint64_t arg_identity(const meta::bare_type_t<T>&) { return 0ull; }
 		};
 
 		// general check for allowed argument types. Used to present meaningful error message wenn invoked with wrong types.
@@ -619,6 +1102,8 @@ namespace simple_cl
 			!std::is_same<meta::bare_type_t<T>, std::nullptr_t>::value
 			, std::true_type, std::false_type>::type;
 
+		class EventList;
+
 		/**
 		* \brief Handle to some OpenCL event. Can be used to synchronize OpenCL operations.
 		*/
@@ -627,6 +1112,8 @@ namespace simple_cl
 			friend class Program;
 			friend class Buffer;
 			friend class Image;
+			friend class EventList;
+			friend class UserEvent;
 
 			template<typename DepIterator>
 			friend void wait_for_events(DepIterator, DepIterator);
@@ -649,15 +1136,153 @@ namespace simple_cl
 			Event& operator=(Event&& other) noexcept;
 
 			/**
-			* \brief Blocks until the corresponding OpenCL command submitted to the command queue finished execution.
+			* \brief Device timestamps of a command in nanoseconds. Only available for commands of queues created with QueueProperties::Profiling.
+			*/
+			struct ProfilingInfo
+			{
+				cl_ulong queued;	///< The command was enqueued by the host.
+				cl_ulong submit;	///< The command was submitted to the device.
+				cl_ulong start;		///< The command started execution on the device.
+				cl_ulong end;		///< The command finished execution on the device.
+
+				/// Time between enqueueing and submission to the device (host side and driver overhead).
+				std::chrono::nanoseconds queue_delay() const { return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(submit - queued)}; }
+				/// Time between submission and start of execution (waiting for the device).
+				std::chrono::nanoseconds submit_delay() const { return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(start - submit)}; }
+				/// Execution time on the device.
+				std::chrono::nanoseconds execution_time() const { return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(end - start)}; }
+				/// Time between enqueueing and completion.
+				std::chrono::nanoseconds total_time() const { return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(end - queued)}; }
+			};
+
+			/**
+			* \brief Blocks until the corresponding OpenCL command submitted to the command queue finished execution. Returns immediately for empty events.
 			*/
 			void wait() const;
+
+			/// Returns true if this object does not refer to a command, e.g. because the command was submitted without events (see Queue::without_events()).
+			bool empty() const noexcept { return m_event == nullptr; }
+
+			/**
+			* \brief Queries the device timestamps of the command. Blocks until the command has completed.
+			* \return Returns the timestamps. Throws a CLException if the command's queue was not created with QueueProperties::Profiling.
+			*/
+			ProfilingInfo profiling_info() const;
+
+			/**
+			* \brief Returns the execution time of the command on the device. Blocks until the command has completed.
+			* \return Returns the execution time. Throws a CLException if the command's queue was not created with QueueProperties::Profiling.
+			*/
+			std::chrono::nanoseconds execution_time() const { return profiling_info().execution_time(); }
+
+			/// Host continuation invoked with the execution status of the command (CL_COMPLETE or a negative error code).
+			using Callback = std::function<void(cl_int)>;
+
+			/**
+			* \brief Registers a host continuation which is run once the command finished execution. Does not block.
+			*
+			* Continuations are not executed on the OpenCL runtime's callback thread but handed to a completion dispatcher thread shared by all events,
+			* so they may block or enqueue further commands. Continuations run one after another in the order in which their commands completed.
+			* Exceptions escaping a continuation are reported to std::cerr and otherwise ignored. Continuations of empty events are dispatched immediately with CL_COMPLETE.
+			* \param callback Continuation to run. Receives the execution status of the command.
+			*/
+			void then(Callback callback) const;
+
+			/**
+			* \brief Returns a future which becomes ready once the command finished execution. Does not block.
+			* \return Returns the future. If the command terminated abnormally, the future stores a CLException with the execution status.
+			*/
+			std::future<void> to_future() const;
 		private:
 			/// Used by wait_for_events<T> free function
-			static void wait_for_events_(const std::vector<cl_event>& events);
+			static void wait_for_events_(const EventList& events);
 			cl_event m_event; ///< Handled cl_event object.
 		};
 
+		/**
+		* \brief Event whose execution status is set by the host, e.g. to gate device work on data which is still being produced by another thread.
+		*
+		* Commands depending on a user event can be enqueued right away, they do not start before the event was signalled. UserEvent's can be
+		* used wherever collections of Event's are accepted and can be signalled from any thread.
+		* \attention A user event must be signalled exactly once. Unsignalled user events block all depending commands (and therefore clFinish) forever.
+		*/
+		class UserEvent : public Event
+		{
+		public:
+			/**
+			* \brief Creates a new user event with execution status CL_SUBMITTED.
+			* \param clstate A valid Context intance used to interface with OpenCL.
+			*/
+			explicit UserEvent(const std::shared_ptr<Context>& clstate);
+
+			/// Sets the execution status to CL_COMPLETE. Depending commands may start execution.
+			void set_complete() const;
+			/**
+			* \brief Marks the event as terminated abnormally. Depending commands are not executed and terminate abnormally as well.
+			* \param error Negative error code.
+			*/
+			void set_failed(cl_int error) const;
+		};
+
+		/**
+		* \brief Contiguous list of cl_event handles of a dependency collection, passed to the OpenCL API functions.
+		*
+		* Up to constants::EVENT_LIST_INLINE_CAPACITY handles are stored inline, so lists are built on the stack without heap
+		* allocations. Longer lists spill into a thread local scratch vector which keeps its capacity, so they only allocate while
+		* it grows. Empty events are skipped.
+		* \attention Instances must not be shared between threads.
+		*/
+		class EventList
+		{
+		public:
+			/// Creates an empty list.
+			EventList() noexcept : m_data{m_inline}, m_size{0ull}, m_capacity{constants::EVENT_LIST_INLINE_CAPACITY}, m_overflow{nullptr}, m_owns_overflow{false} {}
+			/**
+			*	\brief Creates a list of the non-empty events of a collection.
+			*	\tparam DepIterator Iterator which refers to a collection of Event's.
+			*/
+			template <typename DepIterator>
+			EventList(DepIterator begin, DepIterator end) : EventList()
+			{
+				static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[EventList]: Dependency iterators must refer to a collection of Event objects.");
+				for(DepIterator it{begin}; it != end; ++it)
+					if(it->m_event)
+						push_back(it->m_event);
+			}
+			/// Destructor. Returns the scratch memory.
+			~EventList() { if(m_overflow) release_overflow(); }
+
+			EventList(const EventList&) = delete;
+			EventList& operator=(const EventList&) = delete;
+
+			/// Appends a handle.
+			void push_back(cl_event ev)
+			{
+				if(m_size == m_capacity)
+					grow();
+				m_data[m_size++] = ev;
+			}
+			/// Returns the number of handles.
+			std::size_t size() const noexcept { return m_size; }
+			/// Returns true if the list holds no handles.
+			bool empty() const noexcept { return m_size == 0ull; }
+			/// Returns a pointer to the handles, nullptr if the list is empty (as expected by the OpenCL API).
+			const cl_event* data() const noexcept { return m_size > 0ull ? m_data : nullptr; }
+
+		private:
+			/// Moves the handles to (larger) overflow storage.
+			void grow();
+			/// Returns the overflow storage.
+			void release_overflow() noexcept;
+
+			cl_event m_inline[constants::EVENT_LIST_INLINE_CAPACITY];	///< Inline storage.
+			cl_event* m_data;						///< Current storage, m_inline or the overflow storage.
+			std::size_t m_size;						///< Number of handles.
+			std::size_t m_capacity;					///< Capacity of the current storage.
+			std::vector<cl_event>* m_overflow;		///< Thread local scratch or owned heap storage, nullptr while the handles fit inline.
+			bool m_owns_overflow;					///< True if m_overflow is owned because the thread's scratch was in use.
+		};
+
 		/**
 		 *	\brief						Waits for a collection of Event's.
 		 *	\tparam DependencyIterator	Iterator which refers to a collection of Event's.
@@ -667,15 +1292,110 @@ namespace simple_cl
 		template <typename DepIterator>
 		inline void wait_for_events(DepIterator begin, DepIterator end)
 		{
-			static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>, Event>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
-			static std::vector<cl_event> event_cache;
-			event_cache.clear();
-			for(DepIterator it{begin}; it != end; ++it)
-				if(it->m_event)
-					event_cache.push_back(it->m_event);
-			Event::wait_for_events_(event_cache);
+			Event::wait_for_events_(EventList{begin, end});
 		}
 
+		template <typename DepIterator>
+		inline Event Context::enqueue_marker(DepIterator dep_begin, DepIterator dep_end, const Queue& queue) const
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Context]: Dependency iterators must refer to a collection of Event objects.");
+			return enqueue_marker_(EventList{dep_begin, dep_end}, queue);
+		}
+
+		template <typename DepIterator>
+		inline Event Context::enqueue_barrier(DepIterator dep_begin, DepIterator dep_end, const Queue& queue) const
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Context]: Dependency iterators must refer to a collection of Event objects.");
+			return enqueue_barrier_(EventList{dep_begin, dep_end}, queue);
+		}
+
+		/**
+		* \brief Separately compiled OpenCL-C source code which can be linked with other modules into a Program.
+		*
+		* Modules are compiled once (clCompileProgram) and can be reused by any number of Program::link calls, so shared code
+		* like math or utility functions is no longer recompiled as part of every program that needs it. If the binary cache is
+		* enabled (Program::setBinaryCacheDirectory), compiled objects are cached on disk per module.
+		*/
+		class ProgramModule
+		{
+		public:
+			/// Header embedded into the compilation of a module. Resolves '#include "name"' directives in the module source.
+			struct Header
+			{
+				std::string name;	///< Include name as used in the '#include' directive.
+				std::string source;	///< Header source code.
+			};
+
+			/**
+			* \brief	Compiles OpenCL-C source code into a compiled object for all devices of the Context.
+			* \param source String containing the module source code.
+			* \param compiler_options String containing compiler options.
+			* \param clstate A valid Context intance used to interface with OpenCL.
+			* \param headers Embedded headers available to '#include' directives of the source.
+			*/
+			ProgramModule(const std::string& source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate, const std::vector<Header>& headers = std::vector<Header>{});
+			/// Destructor. Frees the cl_program object.
+			~ProgramModule();
+
+			// copy / move constructor
+			/// Copy construction is not allowed.
+			ProgramModule(const ProgramModule&) = delete;
+			/// Moves the entire state into a new instance.
+			ProgramModule(ProgramModule&&) noexcept;
+
+			// copy / move assignment
+			/// Copy assignment is not allowed.
+			ProgramModule& operator=(const ProgramModule& other) = delete;
+			/// Moves the entire state into another instance.
+			ProgramModule& operator=(ProgramModule&& other) noexcept;
+
+		private:
+			friend class Program;
+
+			/// Cleans up internal state.
+			void cleanup() noexcept;
+			/**
+			*	\brief Creates m_cl_program from source and compiles it for the given devices. Prints the compile logs on failure.
+			*	\param device_ids	Devices to compile for.
+			*/
+			void compileFromSource(const std::vector<cl_device_id>& device_ids);
+			/// Returns the cache file path of this module's compiled object for a device.
+			std::string binaryCachePath(const std::string& directory, const Context::CLDevice& device) const;
+
+			std::string m_source;				///< OpenCL module source code.
+			std::string m_options;				///< OpenCL-C compiler options string.
+			std::vector<Header> m_headers;		///< Embedded headers.
+			std::shared_ptr<Context> m_cl_state;	///< Shared pointer to some valid Context instance.
+			cl_program m_cl_program;			///< OpenCL program object handle of the compiled object.
+		};
+
+		/**
+		* \brief Kernel name with its precomputed hash, used to look up kernels by name.
+		*
+		* Implicitly constructible from strings. For string literals and constexpr instances the hash is computed at compile time,
+		* e.g. 'constexpr KernelName saxpy{"saxpy"};', so name based kernel invocations do not hash the name at all.
+		* \attention This is a non owning view of the name. It must not outlive the string it was created from.
+		*/
+		class KernelName
+		{
+		public:
+			/// Creates a kernel name from a zero terminated string.
+			constexpr KernelName(const char* name) noexcept : m_name{name}, m_length{util::cstr_length(name)}, m_hash{util::fnv1a_64_cstr(name)} {}
+			/// Creates a kernel name from a string.
+			KernelName(const std::string& name) noexcept : m_name{name.c_str()}, m_length{name.size()}, m_hash{util::fnv1a_64(name.data(), name.size())} {}
+
+			/// Returns the name.
+			constexpr const char* c_str() const noexcept { return m_name; }
+			/// Returns the length of the name.
+			constexpr std::size_t size() const noexcept { return m_length; }
+			/// Returns the 64 bit FNV-1a hash of the name.
+			constexpr std::uint64_t hash() const noexcept { return m_hash; }
+		private:
+			const char* m_name;
+			std::size_t m_length;
+			std::uint64_t m_hash;
+		};
+
 		/**
 		* \brief Compiles OpenCL-C source code and extracts kernel functions from this source. Found kernels can then be conveniently invoked using the call operator.
 		*/
@@ -689,6 +1409,7 @@ namespace simple_cl
 				std::size_t work_offset[constants::OCL_KERNEL_MAX_WORK_DIM]; ///< Global offset from the origin.
 				std::size_t global_work_size[constants::OCL_KERNEL_MAX_WORK_DIM]; ///< Global work volume dimensions.
 				std::size_t local_work_size[constants::OCL_KERNEL_MAX_WORK_DIM]; ///< Local work group dimensions.
+				Queue queue; ///< Queue (or context device index) to run the kernel on. The default queue of the first device if omitted in aggregate initialization.
 			};
 
 			/**
@@ -702,6 +1423,9 @@ namespace simple_cl
 				std::size_t preferred_work_group_size_multiple = 0ull;	///< Preferred work group size. Work groups should be a multiple of this size and smaller than max_work_group_size. Total local memory used is another limitation to keep in mind.
 			};
 
+		private:
+			struct CLKernel;
+		public:
 			/**
 			* \brief Handle to an OpenCL kernel in this program. Useful to circumvent kernel name lookup to improve performance of invokes.
 			* \attention This is a non owning handle which becomes invalid if the creating Program instance dies.
@@ -713,13 +1437,113 @@ namespace simple_cl
 				CLKernelHandle(const CLKernelHandle& other) noexcept = default;
 				CLKernelHandle& operator=(const CLKernelHandle& other) noexcept = default;
 				~CLKernelHandle() noexcept = default;
-				/// Returns information about the kernel.
-				const CLKernelInfo& getKernelInfo() const { return m_kernel_info; }
+				/**
+				*	\brief Returns information about the kernel.
+				*	\param device_index	Context device index the information refers to.
+				*/
+				inline const CLKernelInfo& getKernelInfo(std::size_t device_index = 0ull) const;
 			private:
 				friend class Program;
-				explicit CLKernelHandle(cl_kernel kernel, const CLKernelInfo& kernel_info) noexcept : m_kernel{kernel}, m_kernel_info{kernel_info} {}
+				explicit CLKernelHandle(cl_kernel kernel, const CLKernel* kernel_record) noexcept : m_kernel{kernel}, m_kernel_record{kernel_record} {}
 				cl_kernel m_kernel = nullptr;
-				CLKernelInfo m_kernel_info;
+				const CLKernel* m_kernel_record = nullptr; ///< Kernel record owned by the creating Program.
+			};
+
+			/**
+			* \brief Kernel invocation with pre-set arguments and execution parameters, created by Program::bind().
+			*
+			* Owns a separate cl_kernel object, so its arguments stay set between launches and are not affected by invokes through
+			* the Program. launch() only enqueues the kernel. Single arguments can be replaced with setArg(), which checks the
+			* argument type against the type passed to bind().
+			* \attention Launching the same BoundKernel from several threads at once requires external synchronization.
+			*/
+			class BoundKernel
+			{
+			public:
+				/// Creates an empty object. Launching it is not allowed.
+				BoundKernel() noexcept = default;
+				/// Destructor. Frees the cl_kernel object.
+				~BoundKernel();
+
+				// copy / move constructor
+				/// Copy construction is not allowed.
+				BoundKernel(const BoundKernel&) = delete;
+				/// Moves the entire state into a new instance.
+				BoundKernel(BoundKernel&& other) noexcept;
+
+				// copy / move assignment
+				/// Copy assignment is not allowed.
+				BoundKernel& operator=(const BoundKernel&) = delete;
+				/// Moves the entire state into another instance.
+				BoundKernel& operator=(BoundKernel&& other) noexcept;
+
+				/**
+				*	\brief Replaces a single kernel argument.
+				*	\tparam T Argument type. Must be the type bound at this index.
+				*	\param index Index of the kernel argument.
+				*	\param arg New argument value.
+				*/
+				template <typename T>
+				void setArg(std::size_t index, const T& arg)
+				{
+					static_assert(is_valid_kernel_arg<T>::value, "[Program]: Incompatible kernel argument type.");
+					if(index >= m_arg_types.size())
+						throw std::out_of_range("[Program]: Kernel argument index out of range.");
+					if(m_arg_types[index] != std::type_index{typeid(meta::bare_type_t<T>)})
+						throw std::runtime_error("[Program]: Kernel argument type does not match the bound type.");
+					setArgImpl(index, KernelArgTraits<T>::arg_size(arg), KernelArgTraits<T>::arg_data(arg));
+				}
+
+				/// Replaces the execution parameters.
+				void setExecParams(const ExecParams& exec_params);
+				/// Returns the execution parameters.
+				const ExecParams& execParams() const noexcept { return m_exec_params; }
+
+				/**
+				*	\brief Enqueues the kernel.
+				*	\return Event object. Calling wait() on this object blocks until the kernel has finished execution.
+				*/
+				Event launch();
+
+				/**
+				*	\brief Enqueues the kernel after waiting for a collection of CLEvents.
+				*	\tparam DependencyIterator Iterator which refers to a collection of Event's.
+				*	\param start_dep_iterator Start iterator of the event collection.
+				*	\param end_dep_iterator End iterator of the event collection.
+				*	\return Event object. Calling wait() on this object blocks until the kernel has finished execution.
+				*/
+				template <typename DependencyIterator>
+				Event launch(DependencyIterator start_dep_iterator, DependencyIterator end_dep_iterator)
+				{
+					static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
+					return enqueue(EventList{start_dep_iterator, end_dep_iterator});
+				}
+
+			private:
+				friend class Program;
+				BoundKernel(cl_kernel kernel, const ExecParams& exec_params, const std::shared_ptr<Context>& clstate, std::vector<std::type_index> arg_types);
+
+				/// Cleans up internal state.
+				void cleanup() noexcept;
+				/// Sets an argument without type checks.
+				void setArgImpl(std::size_t index, std::size_t arg_size, const void* arg_data_ptr);
+				/// Enqueues the kernel on the cached command queue.
+				Event enqueue(const EventList& dep_events);
+
+				template <std::size_t index>
+				void setArgs() {}
+				template <std::size_t index, typename FirstArgType, typename ... ArgTypes>
+				void setArgs(const FirstArgType& first_arg, const ArgTypes&... rest)
+				{
+					setArgImpl(index, KernelArgTraits<FirstArgType>::arg_size(first_arg), KernelArgTraits<FirstArgType>::arg_data(first_arg));
+					setArgs<index + 1, ArgTypes...>(rest...);
+				}
+
+				cl_kernel m_kernel = nullptr;				///< OpenCL kernel object owned by this instance.
+				ExecParams m_exec_params{};					///< Execution parameters used by launch().
+				std::shared_ptr<Context> m_cl_state;		///< Shared pointer to some valid Context instance.
+				cl_command_queue m_queue = nullptr;			///< Command queue resolved from m_exec_params.queue.
+				std::vector<std::type_index> m_arg_types;	///< Bound argument types, one per kernel argument.
 			};
 
 			/**
@@ -759,26 +1583,11 @@ namespace simple_cl
 			*	\return Event object. Calling wait() on this object blocks until the kernel has finished execution.
 			*/
 			template <typename ... ArgTypes>
-			Event operator()(const std::string& name, const ExecParams& exec_params, const ArgTypes&... args)
+			Event operator()(const KernelName& name, const ExecParams& exec_params, const ArgTypes&... args)
 			{
 				static_assert(simple_cl::meta::conjunction<is_valid_kernel_arg<ArgTypes>...>::value, "[Program]: Incompatible kernel argument type.");
-				try
-				{
-					// unpack args
-					setKernelArgs<std::size_t{0}, ArgTypes...> (name, args...);
-
-					// invoke kernel
-					m_event_cache.clear();
-					return invoke(m_kernels.at(name).kernel, m_event_cache, exec_params);
-				}				
-				catch(const std::out_of_range&) // kernel name wasn't found
-				{
-					throw std::runtime_error("[Program]: Unknown kernel name");
-				}
-				catch(...)
-				{
-					throw;
-				}
+				// resolve the name once, arguments are set on the kernel object directly
+				return (*this)(getKernel(name), exec_params, args...);
 			}
 
 			/**
@@ -800,12 +1609,13 @@ namespace simple_cl
 			{
 				assert(kernel.m_kernel);
 				static_assert(simple_cl::meta::conjunction<is_valid_kernel_arg<ArgTypes>...>::value, "[Program]: Incompatible kernel argument type.");					
+				InvokeState& state{invokeState()};
+				const CLKernelHandle invoke_kernel{invokeKernel(state, kernel)};
 				// unpack args
-				setKernelArgs<std::size_t{0}, ArgTypes...>(kernel.m_kernel, args...);
+				setKernelArgs<std::size_t{0}, ArgTypes...>(state, invoke_kernel, args...);
 
 				// invoke kernel
-				m_event_cache.clear();
-				return invoke(kernel.m_kernel, m_event_cache, exec_params);					
+				return invoke(invoke_kernel.m_kernel, EventList{}, exec_params);
 			}
 
 			// overload for zero arguments (no dependencies)
@@ -820,22 +1630,9 @@ namespace simple_cl
 			*	\param exec_params	Defines execution dimensions of global work volume and local work groups for this invocation.
 			*	\return Event object. Calling wait() on this object blocks until the kernel has finished execution.
 			*/
-			Event operator()(const std::string& name, const ExecParams& exec_params)
+			Event operator()(const KernelName& name, const ExecParams& exec_params)
 			{
-				try
-				{
-					// invoke kernel
-					m_event_cache.clear();
-					return invoke(m_kernels.at(name).kernel, m_event_cache, exec_params);
-				}
-				catch(const std::out_of_range&) // kernel name wasn't found
-				{
-					throw std::runtime_error("[Program]: Unknown kernel name");
-				}
-				catch(...)
-				{
-					throw;
-				}
+				return (*this)(getKernel(name), exec_params);
 			}
 
 			/**
@@ -853,9 +1650,9 @@ namespace simple_cl
 			Event operator()(const CLKernelHandle& kernel, const ExecParams& exec_params)
 			{					
 				assert(kernel.m_kernel);
+				InvokeState& state{invokeState()};
 				// invoke kernel
-				m_event_cache.clear();
-				return invoke(kernel.m_kernel, m_event_cache, exec_params);					
+				return invoke(invokeKernel(state, kernel).m_kernel, EventList{}, exec_params);
 			}
 
 			// call operators with dependencies
@@ -877,30 +1674,11 @@ namespace simple_cl
 			*	\return Event object. Calling wait() on this object blocks until the kernel has finished execution.
 			*/
 			template <typename DependencyIterator, typename ... ArgTypes>
-			Event operator()(const std::string& name, DependencyIterator start_dep_iterator, DependencyIterator end_dep_iterator, const ExecParams& exec_params, const ArgTypes&... args)
+			Event operator()(const KernelName& name, DependencyIterator start_dep_iterator, DependencyIterator end_dep_iterator, const ExecParams& exec_params, const ArgTypes&... args)
 			{
-				static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type> , Event>::value , "[Program]: Dependency iterators must refer to a collection of Event objects.");
+				static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
 				static_assert(simple_cl::meta::conjunction<is_valid_kernel_arg<ArgTypes>...>::value, "[Program]: Incompatible kernel argument type.");
-				try
-				{
-					// unpack args
-					setKernelArgs < std::size_t{0}, ArgTypes... > (name, args...);
-
-					// invoke kernel
-					m_event_cache.clear();
-					for(DependencyIterator it{start_dep_iterator}; it != end_dep_iterator; ++it)
-						if(it->m_event)
-							m_event_cache.push_back(it->m_event);
-					return invoke(m_kernels.at(name).kernel, m_event_cache, exec_params);
-				}
-				catch(const std::out_of_range&) // kernel name wasn't found
-				{
-					throw std::runtime_error("[Program]: Unknown kernel name");
-				}
-				catch(...)
-				{
-					throw;
-				}
+				return (*this)(getKernel(name), start_dep_iterator, end_dep_iterator, exec_params, args...);
 			}
 
 			/**
@@ -925,17 +1703,15 @@ namespace simple_cl
 			Event operator()(const CLKernelHandle& kernel, DependencyIterator start_dep_iterator, DependencyIterator end_dep_iterator, const ExecParams& exec_params, const ArgTypes&... args)
 			{
 				assert(kernel.m_kernel);
-				static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>, Event>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
+				static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
 				static_assert(simple_cl::meta::conjunction<is_valid_kernel_arg<ArgTypes>...>::value, "[Program]: Incompatible kernel argument type.");					
+				InvokeState& state{invokeState()};
+				const CLKernelHandle invoke_kernel{invokeKernel(state, kernel)};
 				// unpack args
-				setKernelArgs < std::size_t{0}, ArgTypes... > (kernel.m_kernel, args...);
+				setKernelArgs < std::size_t{0}, ArgTypes... > (state, invoke_kernel, args...);
 
 				// invoke kernel
-				m_event_cache.clear();
-				for(DependencyIterator it{start_dep_iterator}; it != end_dep_iterator; ++it)
-					if(it->m_event)
-						m_event_cache.push_back(it->m_event);
-				return invoke(kernel.m_kernel, m_event_cache, exec_params);					
+				return invoke(invoke_kernel.m_kernel, EventList{start_dep_iterator, end_dep_iterator}, exec_params);
 			}
 
 			// overload for zero arguments (with dependencies)
@@ -954,26 +1730,10 @@ namespace simple_cl
 			*	\return Event object. Calling wait() on this object blocks until the kernel has finished execution.
 			*/
 			template <typename DependencyIterator>
-			Event operator()(const std::string& name, DependencyIterator start_dep_iterator, DependencyIterator end_dep_iterator, const ExecParams& exec_params)
+			Event operator()(const KernelName& name, DependencyIterator start_dep_iterator, DependencyIterator end_dep_iterator, const ExecParams& exec_params)
 			{
-				static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>, Event>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
-				try
-				{
-					// invoke kernel
-					m_event_cache.clear();
-					for(DependencyIterator it{start_dep_iterator}; it != end_dep_iterator; ++it)
-						if(it->m_event)
-							m_event_cache.push_back(it->m_event);
-					return invoke(m_kernels.at(name).kernel, m_event_cache, exec_params);
-				}
-				catch(const std::out_of_range&) // kernel name wasn't found
-				{
-					throw std::runtime_error("[Program]: Unknown kernel name");
-				}
-				catch(...)
-				{
-					throw;
-				}
+				static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
+				return (*this)(getKernel(name), start_dep_iterator, end_dep_iterator, exec_params);
 			}
 
 			/**
@@ -995,13 +1755,10 @@ namespace simple_cl
 			Event operator()(const CLKernelHandle& kernel, DependencyIterator start_dep_iterator, DependencyIterator end_dep_iterator, const ExecParams& exec_params)
 			{				
 				assert(kernel.m_kernel);
-				static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>, Event>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
+				static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DependencyIterator>::value_type>>::value, "[Program]: Dependency iterators must refer to a collection of Event objects.");
+				InvokeState& state{invokeState()};
 				// invoke kernel
-				m_event_cache.clear();
-				for(DependencyIterator it{start_dep_iterator}; it != end_dep_iterator; ++it)
-					if(it->m_event)
-						m_event_cache.push_back(it->m_event);
-				return invoke(kernel.m_kernel, m_event_cache, exec_params);
+				return invoke(invokeKernel(state, kernel).m_kernel, EventList{start_dep_iterator, end_dep_iterator}, exec_params);
 			}
 
 			// retrieve kernel handle
@@ -1009,91 +1766,265 @@ namespace simple_cl
 			*	\brief Returns a kernel handle to the kernel with name name.
 			*	\param name	Name of the kernel to create a handle of.
 			*/
-			CLKernelHandle getKernel(const std::string& name) const;
+			CLKernelHandle getKernel(const KernelName& name) const;
+
+			/**
+			 *	\brief				Returns information about the kernel, specifically information about preferred work group size and memory usage.
+			 *	\param name			Name of the kernel.
+			 *	\param device_index	Context device index the information refers to.
+			 *	\return				CLKernelInfo struct filled with information about the kernel.
+			*/
+			CLKernelInfo getKernelInfo(const KernelName& name, std::size_t device_index = 0ull) const;
 
 			/**
-			 *	\brief			Returns information about the kernel, specifically information about preferred work group size and memory usage.
-			 *	\param name		Name of the kernel.
-			 *	\return			CLKernelInfo struct filled with information about the kernel.
+			 *	\brief				Returns information about the kernel, specifically information about preferred work group size and memory usage.
+			 *	\param kernel		Handle to the kernel.
+			 *	\param device_index	Context device index the information refers to.
+			 *	\return				CLKernelInfo struct filled with information about the kernel.
 			*/
-			CLKernelInfo getKernelInfo(const std::string& name) const;
+			CLKernelInfo getKernelInfo(const CLKernelHandle& kernel, std::size_t device_index = 0ull) const;
 
 			/**
-			 *	\brief			Returns information about the kernel, specifically information about preferred work group size and memory usage.
-			 *	\param kernel	Handle to the kernel.
-			 *	\return			CLKernelInfo struct filled with information about the kernel.
+			*	\brief Creates a BoundKernel for repeated launches of the kernel 'kernel' with the given execution parameters and arguments.
+			*
+			*	All kernel arguments have to be passed. They are set once on a separate cl_kernel object owned by the BoundKernel.
+			*
+			*	\tparam ...Argtypes	List of argument types.
+			*	\param kernel Handle of the kernel function to bind.
+			*	\param exec_params	Execution parameters used by BoundKernel::launch().
+			*	\param args	List of arguments to pass to the kernel.
+			*	\return BoundKernel object. Remains valid if this Program dies.
 			*/
-			CLKernelInfo getKernelInfo(const CLKernelHandle& kernel) const;
+			template <typename ... ArgTypes>
+			BoundKernel bind(const CLKernelHandle& kernel, const ExecParams& exec_params, const ArgTypes&... args)
+			{
+				assert(kernel.m_kernel);
+				static_assert(simple_cl::meta::conjunction<is_valid_kernel_arg<ArgTypes>...>::value, "[Program]: Incompatible kernel argument type.");
+				BoundKernel bound{createKernelCopy(kernel, sizeof...(ArgTypes)), exec_params, m_cl_state, std::vector<std::type_index>{std::type_index{typeid(meta::bare_type_t<ArgTypes>)}...}};
+				bound.setArgs<std::size_t{0}, ArgTypes...>(args...);
+				return bound;
+			}
+
+			/**
+			*	\brief Creates a BoundKernel for repeated launches of the kernel 'name'. See bind(const CLKernelHandle&, ...).
+			*	\param name Name of the kernel function to bind.
+			*	\param exec_params	Execution parameters used by BoundKernel::launch().
+			*	\param args	List of arguments to pass to the kernel.
+			*/
+			template <typename ... ArgTypes>
+			BoundKernel bind(const KernelName& name, const ExecParams& exec_params, const ArgTypes&... args)
+			{
+				return bind(getKernel(name), exec_params, args...);
+			}
+
+			/// Counters of the kernel argument elision.
+			struct KernelArgStats
+			{
+				std::uint64_t set_calls = 0ull;		///< Number of clSetKernelArg calls issued.
+				std::uint64_t elided_calls = 0ull;	///< Number of clSetKernelArg calls skipped because the argument did not change.
+			};
+
+			/**
+			 *	\brief				Returns how many kernel argument updates were issued and skipped by this program.
+			 *
+			 *	Every kernel keeps a copy of the last bytes set at each argument index. Arguments which are passed unchanged to
+			 *	subsequent invokes of the same kernel (e.g. the same Buffer objects in an iterative solver) are not set again.
+			 *	In concurrent invocation mode the counters of all threads are summed up.
+			*/
+			KernelArgStats getKernelArgStats() const;
+			/// Resets the kernel argument counters.
+			void resetKernelArgStats();
+
+			/**
+			 *	\brief				Enables or disables concurrent invocation from multiple host threads.
+			 *
+			 *	By default all invokes share one cl_kernel object per kernel, so invoking the Program from several threads at once
+			 *	requires external synchronization. In concurrent mode every thread lazily creates its own cl_kernel objects and uses
+			 *	its own dependency scratch memory, so the call operators can be used from any number of threads without locking.
+			 *	Only the first invoke of a thread takes a lock. Per-thread kernels are released with the Program.
+			 *
+			 *	\attention			Must not be called while other threads invoke kernels of this Program.
+			 *	\param enabled		True to enable concurrent invocation.
+			*/
+			void setConcurrentInvocation(bool enabled);
+			/// Returns true if concurrent invocation is enabled.
+			bool concurrentInvocation() const noexcept { return m_concurrent_invocation; }
+
+			/**
+			 *	\brief				Enables the process-wide on-disk cache for program binaries.
+			 *
+			 *	Binaries are stored per device, keyed by a hash of source, compiler options, platform name, device name and driver version.
+			 *	On a hit the program is created from the cached binary instead of compiling the source, so a driver update automatically
+			 *	invalidates the affected entries. Corrupt or rejected binaries fall back to a regular build.
+			 *
+			 *	\param directory	Existing directory to store the binaries in. An empty string disables the cache (default).
+			*/
+			static void setBinaryCacheDirectory(const std::string& directory);
+
+			/**
+			 *	\brief				Returns a Program shared by all users of the same source and compiler options within a Context.
+			 *
+			 *	The Context keeps a registry of live shared programs keyed by a hash of the source and the compiler options. If a live
+			 *	instance exists it is returned, otherwise a new Program is built and registered. The registry does not keep programs alive:
+			 *	once the last std::shared_ptr is gone, the next request builds again. Concurrent requests for the same program build it once,
+			 *	requests for different programs build concurrently.
+			 *
+			 *	\attention			Kernel arguments are part of the shared state. Invoking a shared program from several threads at once requires external synchronization
+			 *						or concurrent invocation mode (see setConcurrentInvocation()).
+			 *	\param source		OpenCL-C source code.
+			 *	\param compiler_options	OpenCL compiler options.
+			 *	\param clstate		Shared pointer to a valid Context instance.
+			 *	\return				Shared pointer to the program.
+			*/
+			static std::shared_ptr<Program> getShared(const std::string& source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate);
+
+			/// Source code and compiler options of a program, used for bulk builds.
+			struct SourceDesc
+			{
+				std::string source;				///< OpenCL-C source code.
+				std::string compiler_options;	///< OpenCL compiler options.
+			};
+
+			/**
+			 *	\brief				Builds a program on a separate thread.
+			 *	\param source		OpenCL-C source code.
+			 *	\param compiler_options	OpenCL compiler options.
+			 *	\param clstate		Shared pointer to a valid Context instance.
+			 *	\return				Future which receives the built program or the build exception.
+			*/
+			static std::future<Program> buildAsync(const std::string& source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate);
+
+			/**
+			 *	\brief				Builds many programs concurrently.
+			 *
+			 *	Builds are distributed over up to std::thread::hardware_concurrency() worker threads, so startup time is bounded by the
+			 *	slowest programs rather than the sum of all build times. If builds fail, all other builds are still completed and
+			 *	the exception of the first failed program (in input order) is rethrown.
+			 *
+			 *	\param sources		Programs to build.
+			 *	\param clstate		Shared pointer to a valid Context instance.
+			 *	\return				Built programs in the order of sources.
+			*/
+			static std::vector<Program> buildAll(const std::vector<SourceDesc>& sources, const std::shared_ptr<Context>& clstate);
+
+			/**
+			 *	\brief				Links compiled modules into an executable program.
+			 *
+			 *	Linking is considerably cheaper than compiling, so programs sharing modules only pay for compiling them once.
+			 *	Linked programs are not stored in the binary cache, their modules are.
+			 *
+			 *	\param modules		Modules to link. Must belong to clstate and outlive this call only.
+			 *	\param linker_options	OpenCL linker options.
+			 *	\param clstate		Shared pointer to a valid Context instance.
+			 *	\return				Linked program.
+			*/
+			static Program link(const std::vector<const ProgramModule*>& modules, const std::string& linker_options, const std::shared_ptr<Context>& clstate);
 
 		private:
+			/**
+			* \brief	Takes ownership of a linked program object and extracts all the available kernel functions.
+			* \param linked_program Linked OpenCL program object.
+			* \param linker_options String containing linker options.
+			* \param clstate A valid Context intance used to interface with OpenCL.
+			*/
+			Program(cl_program linked_program, const std::string& linker_options, const std::shared_ptr<Context>& clstate);
+
 			/// Cleans up internal state.
 			void cleanup() noexcept;
 
+			/**
+			*	\brief Creates m_cl_program from source and builds it for the given devices. Prints the build logs on failure.
+			*	\param device_ids	Devices to build for.
+			*/
+			void buildFromSource(const std::vector<cl_device_id>& device_ids);
+			/**
+			*	\brief Tries to create and build m_cl_program from cached binaries.
+			*	\param device_ids	Devices to build for.
+			*	\param directory	Binary cache directory.
+			*	\return Returns true on success. m_cl_program is nullptr otherwise.
+			*/
+			bool loadCachedBinaries(const std::vector<cl_device_id>& device_ids, const std::string& directory);
+			/**
+			*	\brief Stores the binaries of the built m_cl_program in the cache. Failures are ignored.
+			*	\param directory	Binary cache directory.
+			*/
+			void storeCachedBinaries(const std::string& directory) const;
+			/// Returns the cache file path of this program's binary for a device.
+			std::string binaryCachePath(const std::string& directory, const Context::CLDevice& device) const;
+			/**
+			*	\brief Creates all kernels of the built m_cl_program and queries their per-device information.
+			*	\param device_ids	Devices the program was built for.
+			*/
+			void createKernels(const std::vector<cl_device_id>& device_ids);
+			/**
+			*	\brief Creates a new cl_kernel object for the kernel 'kernel'.
+			*	\param kernel	Kernel handle.
+			*	\param num_args	Expected number of kernel arguments.
+			*/
+			cl_kernel createKernelCopy(const CLKernelHandle& kernel, std::size_t num_args) const;
+
+			/**
+				* \brief Copy of the last value passed to clSetKernelArg for one argument index.
+			*/
+			struct KernelArgShadow
+			{
+				bool valid = false;					///< False until the argument was set successfully.
+				bool has_data = false;				///< False for arguments without data (local memory).
+				std::size_t size = 0ull;			///< Argument size in bytes.
+				std::uint64_t identity = 0ull;		///< Identity of memory object arguments (see has_arg_identity), 0 for plain data.
+				std::vector<unsigned char> bytes;	///< Argument bytes if has_data.
+			};
+
 			/**
 				* \brief Holds running id and OpenCL kernel object handle.
 			*/
 			struct CLKernel
 			{
 				std::size_t id;		///< Running id
-				CLKernelInfo kernel_info; ///< Information about the kernel
+				std::string name;	///< Kernel function name
+				std::vector<CLKernelInfo> kernel_info; ///< Information about the kernel, one entry per context device
 				cl_kernel kernel;	///< OpenCL kernel object handle
+				mutable std::vector<KernelArgShadow> arg_shadow;	///< Last value set at each argument index. Cache state, hence mutable.
+			};
+
+			/**
+				* \brief Scratch state of invokes. One instance in single threaded mode, one per thread in concurrent invocation mode.
+			*/
+			struct InvokeState
+			{
+				std::vector<CLKernel> kernels;					///< Per-thread kernels, indexed by CLKernel::id. Created lazily, unused in single threaded mode.
+				std::atomic<std::uint64_t> set_calls{0ull};		///< See KernelArgStats.
+				std::atomic<std::uint64_t> elided_calls{0ull};	///< See KernelArgStats.
+			};
+
+			/// Per-thread invoke states of the concurrent invocation mode.
+			struct ThreadInvokeStates
+			{
+				std::mutex mutex;	///< Guards states.
+				std::unordered_map<std::thread::id, std::unique_ptr<InvokeState>> states;	///< Invoke states keyed by thread.
 			};
 
+			/// Returns the invoke state of the calling thread.
+			InvokeState& invokeState();
+			/// Returns the kernel to invoke on the calling thread: 'kernel' itself or the thread's own instance of it in concurrent invocation mode.
+			CLKernelHandle invokeKernel(InvokeState& state, const CLKernelHandle& kernel);
+
 			// invoke kernel
 			/**
 			*	\brief invokes the kernel.
 			*	\param kernel	OpenCL kernel object handle
-			*	\param dep_events	Vector of events to wait for. (std::vector because we need them in contiguous memory for the API call)
+			*	\param dep_events	Events to wait for.
 			*	\param exec_params	Execution dimensions.
 			*/
-			Event invoke(cl_kernel kernel, const std::vector<cl_event>& dep_events, const ExecParams& exec_params);
+			Event invoke(cl_kernel kernel, const EventList& dep_events, const ExecParams& exec_params);
 			// set kernel params (low level, non type-safe stuff. Implementation hidden in .cpp!)
 			/**
-			*	\brief Sets kernel arguments in a low-level fashion.
-			*	\attention This function is not type safe. Use the high level functions above instead!
-			*	\param name Name of the kernel.
-			*/
-			void setKernelArgsImpl(const std::string& name, std::size_t index, std::size_t arg_size, const void* arg_data_ptr);
-			/**
-			*	\brief Sets kernel arguments in a low-level fashion.
+			*	\brief Sets kernel arguments in a low-level fashion. Skips the call if the argument is unchanged since the last call.
 			*	\attention This function is not type safe. Use the high level functions above instead!
-			*	\param kernel	OpenCL kernel object handle.
-			*/
-			void setKernelArgsImpl(cl_kernel kernel, std::size_t index, std::size_t arg_size, const void* arg_data_ptr);
-
-			// template parameter pack unpacking
-			/**
-			*	\brief	Unpacks and sets an arbitrary kernel argument list.
-			*	\tparam index	Index of the first argument of the list.
-			*	\tparam FirstArgType Type of the first argument.
-			*	\tparam ...ArgTypes	List of kernel argument types (tail).
-			*	\param name	Name of the kernel.
-			*	\param first_arg First argument.
-			*	\param rest	Rest of arguments (tail).
-			*/
-			template <std::size_t index, typename FirstArgType, typename ... ArgTypes>
-			void setKernelArgs(const std::string& name, const FirstArgType& first_arg, const ArgTypes&... rest)
-			{
-				// process first_arg
-				setKernelArgs<index, FirstArgType>(name, first_arg);
-				// unpack next param
-				setKernelArgs<index + 1, ArgTypes...>(name, rest...);
-			}
-
-			// exit case
-			/**
-			*	\brief	Unpacks and sets a single kernel argument.
-			*	\tparam index Index of the kernel argument.
-			*	\tparam FirstArgType Type of the argument.
-			*	\param name	Name of the kernel.
-			*	\param first_arg Argument.
-			*/
-			template <std::size_t index, typename FirstArgType>
-			void setKernelArgs(const std::string& name, const FirstArgType& first_arg)
-			{
-				// set opencl kernel argument
-				setKernelArgsImpl(name, index, KernelArgTraits<FirstArgType>::arg_size(first_arg), KernelArgTraits<FirstArgType>::arg_data(first_arg));
-			}
+			*	\param state	Invoke state counting the calls.
+			*	\param kernel	Kernel handle.
+			*/
+			void setKernelArgsImpl(InvokeState& state, const CLKernelHandle& kernel, std::size_t index, std::size_t arg_size, const void* arg_data_ptr, std::uint64_t arg_identity);
 
 			// template parameter pack unpacking
 			/**
@@ -1101,17 +2032,18 @@ namespace simple_cl
 			*	\tparam index Index of the first argument of the list.
 			*	\tparam FirstArgType Type of the first argument.
 			*	\tparam ...ArgTypes	List of kernel argument types (tail).
-			*	\param kernel OpenCL kernel object handle.
+			*	\param state Invoke state of the calling thread.
+			*	\param kernel Kernel handle.
 			*	\param first_arg First argument.
 			*	\param rest	Rest of arguments (tail).
 			*/
 			template <std::size_t index, typename FirstArgType, typename ... ArgTypes>
-			void setKernelArgs(cl_kernel kernel, const FirstArgType& first_arg, const ArgTypes&... rest)
+			void setKernelArgs(InvokeState& state, const CLKernelHandle& kernel, const FirstArgType& first_arg, const ArgTypes&... rest)
 			{
 				// process first_arg
-				setKernelArgs<index, FirstArgType>(kernel, first_arg);
+				setKernelArgs<index, FirstArgType>(state, kernel, first_arg);
 				// unpack next param
-				setKernelArgs<index + 1, ArgTypes...>(kernel, rest...);
+				setKernelArgs<index + 1, ArgTypes...>(state, kernel, rest...);
 			}
 
 			// exit case
@@ -1119,23 +2051,35 @@ namespace simple_cl
 			*	\brief	Unpacks and sets a single kernel argument.
 			*	\tparam index Index of the kernel argument.
 			*	\tparam FirstArgType Type of the argument.
-			*	\param kernel OpenCL kernel object handle.
+			*	\param state Invoke state of the calling thread.
+			*	\param kernel Kernel handle.
 			*	\param first_arg Argument.
 			*/
 			template <std::size_t index, typename FirstArgType>
-			void setKernelArgs(cl_kernel kernel, const FirstArgType& first_arg)
+			void setKernelArgs(InvokeState& state, const CLKernelHandle& kernel, const FirstArgType& first_arg)
 			{
 				// set opencl kernel argument
-				setKernelArgsImpl(kernel, index, KernelArgTraits<FirstArgType>::arg_size(first_arg), KernelArgTraits<FirstArgType>::arg_data(first_arg));
+				setKernelArgsImpl(state, kernel, index, KernelArgTraits<FirstArgType>::arg_size(first_arg), KernelArgTraits<FirstArgType>::arg_data(first_arg), KernelArgTraits<FirstArgType>::arg_identity(first_arg));
 			}
 
 			std::string m_source;	///< OpenCL program source code.
 			std::string m_options;	///< OpenCL-C compiler options string.
-			std::unordered_map<std::string, CLKernel> m_kernels;	///< Map of kernels found in the program, keyed by kernel name.
+			std::unordered_map<std::uint64_t, CLKernel> m_kernels;	///< Map of kernels found in the program, keyed by the FNV-1a hash of the kernel name (see KernelName).
 			cl_program m_cl_program;	///< OpenCL program object handle
 			std::shared_ptr<Context> m_cl_state;	///< Shared pointer to some valid Context instance.
-			std::vector<cl_event> m_event_cache;	///< Used for caching lists of events in contiguous memory.
+			std::uint64_t m_uid;	///< Process-wide unique id of this program, keys the per-thread lookup of invoke states.
+			bool m_concurrent_invocation;	///< True if every thread invokes its own kernel instances.
+			std::unique_ptr<InvokeState> m_invoke_state;	///< Invoke state of the single threaded mode.
+			std::shared_ptr<ThreadInvokeStates> m_thread_invoke_states;	///< Invoke states of the concurrent invocation mode. Shared so that threads can detect dead programs.
 		};
+
+		inline const Program::CLKernelInfo& Program::CLKernelHandle::getKernelInfo(std::size_t device_index) const
+		{
+			assert(m_kernel_record);
+			if(device_index >= m_kernel_record->kernel_info.size())
+				throw std::out_of_range("[Program]: Device index out of range.");
+			return m_kernel_record->kernel_info[device_index];
+		}
 		#pragma endregion
 		
 		#pragma region buffers
@@ -1156,6 +2100,46 @@ namespace simple_cl
 		class Buffer
 		{
 		public:
+			/**
+				*	\brief Offset of a rectangular region. Default offsets are 0.
+			*/
+			struct RectOffset
+			{
+				constexpr RectOffset(std::size_t bytes = 0ull, std::size_t rows = 0ull, std::size_t slices = 0ull) : offset_bytes{bytes}, offset_rows{rows}, offset_slices{slices} {}
+				std::size_t offset_bytes;	///< Offset within a row in bytes.
+				std::size_t offset_rows;	///< Offset in rows.
+				std::size_t offset_slices;	///< Offset in slices.
+			};
+
+			/**
+				*	\brief Dimensions of a rectangular region. Use height and depth 1 for 1D and 2D regions.
+			*/
+			struct RectRegion
+			{
+				constexpr RectRegion(std::size_t width_bytes = 0ull, std::size_t height = 1ull, std::size_t depth = 1ull) : width_bytes{width_bytes}, height{height}, depth{depth} {}
+				std::size_t width_bytes;	///< Width of a row in bytes.
+				std::size_t height;			///< Number of rows.
+				std::size_t depth;			///< Number of slices.
+			};
+
+			/**
+				*	\brief Row and slice pitch of memory holding 2D or 3D data in bytes. 0 means tightly packed: row pitch = region width, slice pitch = region height * row pitch.
+			*/
+			struct RectPitch
+			{
+				constexpr RectPitch(std::size_t row_pitch = 0ull, std::size_t slice_pitch = 0ull) : row_pitch{row_pitch}, slice_pitch{slice_pitch} {}
+				std::size_t row_pitch;		///< Distance between the beginnings of two consecutive rows in bytes.
+				std::size_t slice_pitch;	///< Distance between the beginnings of two consecutive slices in bytes.
+			};
+
+			/**
+				*	\brief Position of a rectangular region in memory holding 2D or 3D data.
+			*/
+			struct RectLayout
+			{
+				RectOffset offset;	///< Offset of the region.
+				RectPitch pitch;	///< Pitch of the memory.
+			};
 
 			/**
 				*	\brief			Creates a new Buffer instance and allocates an OpenCL buffer.
@@ -1184,13 +2168,14 @@ namespace simple_cl
 			*	\param[in]		length		Length of the data to be written in bytes. If 0 (default), the whole buffer will be written and the offset is ignored.
 			*	\param[in]		offset		Offset into the buffer where the region to be written begins. Ignored if length is 0.
 			*	\param[in]		invalidate	If true, the written region will be invalidated which provides performance benefits in most cases.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return			Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*	
 			*	\attention		This is a low level function. Please consider using one of the type-safe versions instead. If this function is used directly make sure that access to data*
 			*					in the region [data, data + length - 1] does not produce access violations!
 			*/
-			inline Event write_bytes(const void* data, std::size_t length = 0ull, std::size_t offset = 0ull, bool invalidate = false);
+			inline Event write_bytes(const void* data, std::size_t length = 0ull, std::size_t offset = 0ull, bool invalidate = false, const Queue& queue = Queue{});
 
 			/**
 			*	Copies data from the OpenCL buffer into the memory region pointed to by data.
@@ -1200,13 +2185,14 @@ namespace simple_cl
 			*	\param[out]		data		Points to the memory region the buffer should be read into.
 			*	\param[in]		length		Length of the data to be read in bytes. If 0 (default), the whole buffer will be read and the offset is ignored.
 			*	\param[in]		offset		Offset into the buffer where the region to be read begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return			Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*
 			*	\attention		This is a low level function. Please consider using one of the type-safe versions instead. If this function is used directly make sure that access to data*
 			*					in the region [data, data + length - 1] does not produce access violations!
 			*/
-			inline Event read_bytes(void* data, std::size_t length = 0ull, std::size_t offset = 0ull);
+			inline Event read_bytes(void* data, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{});
 
 			/** 
 			*	Copies data pointed to by data into the OpenCL buffer after waiting on a list of dependencies (Event's).
@@ -1224,6 +2210,7 @@ namespace simple_cl
 			*	\param[in]		length		Length of the data to be written in bytes. If 0 (default), the whole buffer will be written and the offset is ignored.
 			*	\param[in]		offset		Offset into the buffer where the region to be written begins. Ignored if length is 0.
 			*	\param[in]		invalidate	If true, the written region will be invalidated which provides performance benefits in most cases.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return			Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*
@@ -1231,7 +2218,7 @@ namespace simple_cl
 			*					in the region [data, data + length - 1] does not produce access violations!
 			*/
 			template <typename DepIterator>
-			inline Event write_bytes(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t offset = 0ull, bool invalidate = false);
+			inline Event write_bytes(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t offset = 0ull, bool invalidate = false, const Queue& queue = Queue{});
 
 			/**
 			*	Copies data from the OpenCL buffer into the memory region pointed to by data after waiting on a list of dependencies (Event's).
@@ -1246,6 +2233,7 @@ namespace simple_cl
 			*	\param[in]		dep_end		End iterator of a collection of Event's.
 			*	\param[in]		length		Length of the data to be read in bytes. If 0 (default), the whole buffer will be read and the offset is ignored.
 			*	\param[in]		offset		Offset into the buffer where the region to be read begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return			Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*
@@ -1253,7 +2241,235 @@ namespace simple_cl
 			*					in the region [data, data + length - 1] does not produce access violations!
 			*/
 			template <typename DepIterator>
-			inline Event read_bytes(void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t offset = 0ull);
+			inline Event read_bytes(void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{});
+
+			// asynchronous transfers
+			/**
+			*	\brief Enqueues a non-blocking copy of data into the OpenCL buffer. Returns immediately.
+			*
+			*	In contrast to write_bytes, the host does not wait for prior commands of the queue. The runtime reads from data while the command executes,
+			*	so data must stay valid and must not be modified until the returned Event has completed. Use write_bytes_staged if the source cannot be kept alive.
+			*
+			*	\param[in]		data		Points to the data to be written into the buffer. Must stay valid until the transfer has completed.
+			*	\param[in]		length		Length of the data to be written in bytes. If 0 (default), the whole buffer will be written and the offset is ignored.
+			*	\param[in]		offset		Offset into the buffer where the region to be written begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return			Returns the Event of the write command. Completion has to be established otherwise for queues returned by Queue::without_events().
+			*/
+			inline Event write_bytes_async(const void* data, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{});
+
+			/**
+			*	\brief Enqueues a non-blocking copy of data into the OpenCL buffer after waiting on a list of dependencies (Event's). Returns immediately.
+			*	\tparam			DepIterator	Input iterator to iterate over a collection of Event's.
+			*	\param[in]		data		Points to the data to be written into the buffer. Must stay valid until the transfer has completed.
+			*	\param[in]		dep_begin	Start iterator of a collection of Event's.
+			*	\param[in]		dep_end		End iterator of a collection of Event's.
+			*	\param[in]		length		Length of the data to be written in bytes. If 0 (default), the whole buffer will be written and the offset is ignored.
+			*	\param[in]		offset		Offset into the buffer where the region to be written begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return			Returns the Event of the write command.
+			*/
+			template <typename DepIterator>
+			inline Event write_bytes_async(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{});
+
+			/**
+			*	\brief Copies data into library owned staging memory and enqueues a non-blocking write from there. Returns immediately.
+			*
+			*	The source may be modified or freed as soon as the function returns. The staging memory is released once the write command has completed.
+			*	Costs an additional host side copy compared to write_bytes_async.
+			*
+			*	\param[in]		data		Points to the data to be written into the buffer.
+			*	\param[in]		length		Length of the data to be written in bytes. If 0 (default), the whole buffer will be written and the offset is ignored.
+			*	\param[in]		offset		Offset into the buffer where the region to be written begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return			Returns the Event of the write command, an empty event for queues returned by Queue::without_events().
+			*/
+			inline Event write_bytes_staged(const void* data, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{});
+
+			/**
+			*	\brief Copies data into library owned staging memory and enqueues a non-blocking write from there after waiting on a list of dependencies (Event's). Returns immediately.
+			*	\tparam			DepIterator	Input iterator to iterate over a collection of Event's.
+			*	\param[in]		data		Points to the data to be written into the buffer.
+			*	\param[in]		dep_begin	Start iterator of a collection of Event's.
+			*	\param[in]		dep_end		End iterator of a collection of Event's.
+			*	\param[in]		length		Length of the data to be written in bytes. If 0 (default), the whole buffer will be written and the offset is ignored.
+			*	\param[in]		offset		Offset into the buffer where the region to be written begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return			Returns the Event of the write command, an empty event for queues returned by Queue::without_events().
+			*/
+			template <typename DepIterator>
+			inline Event write_bytes_staged(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{});
+
+			/**
+			*	\brief Enqueues a non-blocking copy from the OpenCL buffer into the memory region pointed to by data. Returns immediately.
+			*
+			*	data must stay valid and must neither be read nor written until the returned Event has completed.
+			*
+			*	\param[out]		data		Points to the memory region the buffer should be read into. Must stay valid until the transfer has completed.
+			*	\param[in]		length		Length of the data to be read in bytes. If 0 (default), the whole buffer will be read and the offset is ignored.
+			*	\param[in]		offset		Offset into the buffer where the region to be read begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return			Returns the Event of the read command. Completion has to be established otherwise for queues returned by Queue::without_events().
+			*/
+			inline Event read_bytes_async(void* data, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{}) const;
+
+			/**
+			*	\brief Enqueues a non-blocking copy from the OpenCL buffer into the memory region pointed to by data after waiting on a list of dependencies (Event's). Returns immediately.
+			*	\tparam			DepIterator	Input iterator to iterate over a collection of Event's.
+			*	\param[out]		data		Points to the memory region the buffer should be read into. Must stay valid until the transfer has completed.
+			*	\param[in]		dep_begin	Start iterator of a collection of Event's.
+			*	\param[in]		dep_end		End iterator of a collection of Event's.
+			*	\param[in]		length		Length of the data to be read in bytes. If 0 (default), the whole buffer will be read and the offset is ignored.
+			*	\param[in]		offset		Offset into the buffer where the region to be read begins. Ignored if length is 0.
+			*	\param[in]		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return			Returns the Event of the read command.
+			*/
+			template <typename DepIterator>
+			inline Event read_bytes_async(void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{}) const;
+
+			// rectangular transfers
+			/**
+			*	\brief Copies a 2D or 3D region of strided host memory into a region of the OpenCL buffer with a single command.
+			*
+			*	E.g. a tile of a larger row-major host matrix is uploaded by setting the host row pitch to the matrix row size in bytes.
+			*	If blocking is false, data must stay valid and must not be modified until the returned Event has completed.
+			*
+			*	\param[in]	data			Points to the beginning of the host memory (the region's offset is applied by host_layout).
+			*	\param		host_layout		Offset of the region and pitch of the host memory.
+			*	\param		buffer_layout	Offset of the region and pitch of the data in the buffer.
+			*	\param		region			Dimensions of the region to copy.
+			*	\param		blocking		If true, the call returns after the host memory has been read.
+			*	\param		queue			Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the write command.
+			*/
+			inline Event write_rect(const void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking = true, const Queue& queue = Queue{});
+
+			/**
+			*	\brief Copies a 2D or 3D region of strided host memory into a region of the OpenCL buffer after waiting on a list of dependencies (Event's).
+			*	\tparam		DepIterator		Some iterator type fulfilling the LegacyInputIterator named requirement and referring to Event objects.
+			*	\param[in]	data			Points to the beginning of the host memory (the region's offset is applied by host_layout).
+			*	\param		host_layout		Offset of the region and pitch of the host memory.
+			*	\param		buffer_layout	Offset of the region and pitch of the data in the buffer.
+			*	\param		region			Dimensions of the region to copy.
+			*	\param		dep_begin		Begin iterator of Event collection.
+			*	\param		dep_end			End iterator of Event collection.
+			*	\param		blocking		If true, the call returns after the host memory has been read.
+			*	\param		queue			Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the write command.
+			*/
+			template <typename DepIterator>
+			inline Event write_rect(const void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, DepIterator dep_begin, DepIterator dep_end, bool blocking = true, const Queue& queue = Queue{});
+
+			/**
+			*	\brief Copies a 2D or 3D region of the OpenCL buffer into strided host memory with a single command.
+			*
+			*	If blocking is false, data must stay valid and must neither be read nor written until the returned Event has completed.
+			*
+			*	\param[out]	data			Points to the beginning of the host memory (the region's offset is applied by host_layout).
+			*	\param		host_layout		Offset of the region and pitch of the host memory.
+			*	\param		buffer_layout	Offset of the region and pitch of the data in the buffer.
+			*	\param		region			Dimensions of the region to copy.
+			*	\param		blocking		If true, the call returns after the data has been written to host memory.
+			*	\param		queue			Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the read command.
+			*/
+			inline Event read_rect(void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking = true, const Queue& queue = Queue{}) const;
+
+			/**
+			*	\brief Copies a 2D or 3D region of the OpenCL buffer into strided host memory after waiting on a list of dependencies (Event's).
+			*	\tparam		DepIterator		Some iterator type fulfilling the LegacyInputIterator named requirement and referring to Event objects.
+			*	\param[out]	data			Points to the beginning of the host memory (the region's offset is applied by host_layout).
+			*	\param		host_layout		Offset of the region and pitch of the host memory.
+			*	\param		buffer_layout	Offset of the region and pitch of the data in the buffer.
+			*	\param		region			Dimensions of the region to copy.
+			*	\param		dep_begin		Begin iterator of Event collection.
+			*	\param		dep_end			End iterator of Event collection.
+			*	\param		blocking		If true, the call returns after the data has been written to host memory.
+			*	\param		queue			Command queue executing the transfer. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the read command.
+			*/
+			template <typename DepIterator>
+			inline Event read_rect(void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, DepIterator dep_begin, DepIterator dep_end, bool blocking = true, const Queue& queue = Queue{}) const;
+
+			// device side operations
+			/**
+			*	\brief Enqueues a device side copy of a byte range into another buffer. Does not block and does not involve host memory.
+			*	\param		dst				Destination buffer. May be this buffer if source and destination ranges do not overlap.
+			*	\param		length			Number of bytes to copy. If 0 (default), the whole buffer is copied and the offsets are ignored.
+			*	\param		src_offset		Offset into this buffer in bytes.
+			*	\param		dst_offset		Offset into the destination buffer in bytes.
+			*	\param		queue			Command queue executing the copy. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the copy command.
+			*/
+			inline Event copy_to(Buffer& dst, std::size_t length = 0ull, std::size_t src_offset = 0ull, std::size_t dst_offset = 0ull, const Queue& queue = Queue{}) const;
+
+			/**
+			*	\brief Enqueues a device side copy of a byte range into another buffer after waiting on a list of dependencies (Event's). Does not block.
+			*	\tparam		DepIterator		Some iterator type fulfilling the LegacyInputIterator named requirement and referring to Event objects.
+			*	\param		dst				Destination buffer. May be this buffer if source and destination ranges do not overlap.
+			*	\param		dep_begin		Begin iterator of Event collection.
+			*	\param		dep_end			End iterator of Event collection.
+			*	\param		length			Number of bytes to copy. If 0 (default), the whole buffer is copied and the offsets are ignored.
+			*	\param		src_offset		Offset into this buffer in bytes.
+			*	\param		dst_offset		Offset into the destination buffer in bytes.
+			*	\param		queue			Command queue executing the copy. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the copy command.
+			*/
+			template <typename DepIterator, typename = typename std::enable_if<!std::is_integral<DepIterator>::value>::type>
+			inline Event copy_to(Buffer& dst, DepIterator dep_begin, DepIterator dep_end, std::size_t length = 0ull, std::size_t src_offset = 0ull, std::size_t dst_offset = 0ull, const Queue& queue = Queue{}) const;
+
+			/**
+			*	\brief Enqueues a device side copy of a 2D or 3D region into another buffer. Does not block and does not involve host memory.
+			*	\param		dst				Destination buffer. May be this buffer if source and destination regions do not overlap.
+			*	\param		src_layout		Offset of the region and pitch of the data in this buffer.
+			*	\param		dst_layout		Offset of the region and pitch of the data in the destination buffer.
+			*	\param		region			Dimensions of the region to copy.
+			*	\param		queue			Command queue executing the copy. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the copy command.
+			*/
+			inline Event copy_rect(Buffer& dst, const RectLayout& src_layout, const RectLayout& dst_layout, const RectRegion& region, const Queue& queue = Queue{}) const;
+
+			/**
+			*	\brief Enqueues a device side copy of a 2D or 3D region into another buffer after waiting on a list of dependencies (Event's). Does not block.
+			*	\tparam		DepIterator		Some iterator type fulfilling the LegacyInputIterator named requirement and referring to Event objects.
+			*	\param		dst				Destination buffer. May be this buffer if source and destination regions do not overlap.
+			*	\param		src_layout		Offset of the region and pitch of the data in this buffer.
+			*	\param		dst_layout		Offset of the region and pitch of the data in the destination buffer.
+			*	\param		region			Dimensions of the region to copy.
+			*	\param		dep_begin		Begin iterator of Event collection.
+			*	\param		dep_end			End iterator of Event collection.
+			*	\param		queue			Command queue executing the copy. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the copy command.
+			*/
+			template <typename DepIterator>
+			inline Event copy_rect(Buffer& dst, const RectLayout& src_layout, const RectLayout& dst_layout, const RectRegion& region, DepIterator dep_begin, DepIterator dep_end, const Queue& queue = Queue{}) const;
+
+			/**
+			*	\brief Enqueues a device side fill of a range of the buffer with a repeated pattern. Does not block and does not involve host memory.
+			*	\tparam		T				Pattern type. Must have standard layout and a size of 1, 2, 4, 8, 16, 32, 64 or 128 bytes (e.g. cl_float4).
+			*	\param		pattern			Pattern the range is filled with.
+			*	\param		offset			Offset into the OpenCL buffer: offset * sizeof(T) bytes.
+			*	\param		count			Number of patterns to write. If 0 (default), the whole buffer is filled and the offset is ignored.
+			*	\param		queue			Command queue executing the fill. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the fill command.
+			*/
+			template <typename T>
+			inline Event fill(const T& pattern, std::size_t offset = 0ull, std::size_t count = 0ull, const Queue& queue = Queue{});
+
+			/**
+			*	\brief Enqueues a device side fill of a range of the buffer with a repeated pattern after waiting on a list of dependencies (Event's). Does not block.
+			*	\tparam		T				Pattern type. Must have standard layout and a size of 1, 2, 4, 8, 16, 32, 64 or 128 bytes (e.g. cl_float4).
+			*	\tparam		DepIterator		Some iterator type fulfilling the LegacyInputIterator named requirement and referring to Event objects.
+			*	\param		pattern			Pattern the range is filled with.
+			*	\param		dep_begin		Begin iterator of Event collection.
+			*	\param		dep_end			End iterator of Event collection.
+			*	\param		offset			Offset into the OpenCL buffer: offset * sizeof(T) bytes.
+			*	\param		count			Number of patterns to write. If 0 (default), the whole buffer is filled and the offset is ignored.
+			*	\param		queue			Command queue executing the fill. Defaults to the queue of the first context device.
+			*	\return		Returns the Event of the fill command.
+			*/
+			template <typename T, typename DepIterator, typename = typename std::enable_if<!std::is_integral<DepIterator>::value>::type>
+			inline Event fill(const T& pattern, DepIterator dep_begin, DepIterator dep_end, std::size_t offset = 0ull, std::size_t count = 0ull, const Queue& queue = Queue{});
 
 			// high level read / write
 			/**
@@ -1263,10 +2479,11 @@ namespace simple_cl
 			*	\param		data_end		End iterator of data.
 			*	\param		offset			Offset into the OpenCL buffer: offset * sizeof(std::iterator_traits<DataIterator>::value_type) bytes.
 			*	\param		invalidate		When true, invalidates the whole mapped memory region. This increases transfer performance in most cases.
+			*	\param		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*	\return		Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*/
 			template <typename DataIterator>
-			inline Event write(DataIterator data_begin, DataIterator data_end, std::size_t offset = 0ull, bool invalidate = false);
+			inline Event write(DataIterator data_begin, DataIterator data_end, std::size_t offset = 0ull, bool invalidate = false, const Queue& queue = Queue{});
 
 			/**
 			*	\brief Reads some collection of POC data from the buffer, starting at some byte offset.
@@ -1274,10 +2491,11 @@ namespace simple_cl
 			*	\param		data_begin		Begin iterator of data.
 			*	\param		num_elements	Number of elements to read from the OpenCL buffer.
 			*	\param		offset			Offset into the OpenCL buffer: offset * sizeof(std::iterator_traits<DataIterator>::value_type) bytes.
+			*	\param		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*	\return		Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*/
 			template <typename DataIterator>
-			inline Event read(DataIterator data_begin, std::size_t num_elements, std::size_t offset = 0ull);
+			inline Event read(DataIterator data_begin, std::size_t num_elements, std::size_t offset = 0ull, const Queue& queue = Queue{});
 
 			// with dependencies
 			/**
@@ -1290,10 +2508,11 @@ namespace simple_cl
 			*	\param		dep_end			End iterator of Event collection.
 			*	\param		offset			Offset into the OpenCL buffer: offset * sizeof(std::iterator_traits<DataIterator>::value_type) bytes.
 			*	\param		invalidate		When true, invalidates the whole mapped memory region. This increases transfer performance in most cases.
+			*	\param		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*	\return		Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*/
 			template <typename DataIterator, typename DepIterator>
-			inline Event write(DataIterator data_begin, DataIterator data_end, DepIterator dep_begin, DepIterator dep_end, std::size_t offset = 0ull, bool invalidate = false);
+			inline Event write(DataIterator data_begin, DataIterator data_end, DepIterator dep_begin, DepIterator dep_end, std::size_t offset = 0ull, bool invalidate = false, const Queue& queue = Queue{});
 
 			/**
 			*	\brief Reads some collection of POC data from the buffer, starting at some byte offset, after waiting on a list of Event's.
@@ -1304,14 +2523,40 @@ namespace simple_cl
 			*	\param		dep_begin		Begin iterator of Event collection.
 			*	\param		dep_end			End iterator of Event collection.
 			*	\param		offset			Offset into the OpenCL buffer: offset * sizeof(std::iterator_traits<DataIterator>::value_type) bytes.
+			*	\param		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*	\return		Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*/
 			template <typename DataIterator, typename DepIterator>
-			inline Event read(DataIterator data_begin, std::size_t num_elements, DepIterator dep_begin, DepIterator dep_end, std::size_t offset = 0ull);
+			inline Event read(DataIterator data_begin, std::size_t num_elements, DepIterator dep_begin, DepIterator dep_end, std::size_t offset = 0ull, const Queue& queue = Queue{});
 
 			/// Reports size of allocated device memory in bytes.
 			std::size_t size() const noexcept;
 
+			// sub-buffers
+			/**
+			*	\brief Creates a view of a range of this buffer (clCreateSubBuffer). No memory is allocated.
+			*
+			*	The returned Buffer can be used like any other Buffer, e.g. as kernel argument. It keeps the parent's memory alive, so it may outlive this object.
+			*	Writes through overlapping views (or the parent) while a kernel is using another view are undefined.
+			*
+			*	\param offset	Offset of the range in bytes. Must be a multiple of sub_buffer_alignment().
+			*	\param size		Size of the range in bytes.
+			*	\param flags	Access flags of the view. Must not be less restrictive than the flags of this buffer. The host pointer option must be HostPointerOption::None.
+			*	\return			Returns the view.
+			*/
+			Buffer sub_buffer(std::size_t offset, std::size_t size, const MemoryFlags& flags) const;
+			/**
+			*	\brief Creates a view of a range of this buffer (clCreateSubBuffer) with the access flags of this buffer. No memory is allocated.
+			*	\param offset	Offset of the range in bytes. Must be a multiple of sub_buffer_alignment().
+			*	\param size		Size of the range in bytes.
+			*	\return			Returns the view.
+			*/
+			Buffer sub_buffer(std::size_t offset, std::size_t size) const;
+			/// Returns the alignment in bytes required for sub-buffer offsets by all devices of the context (CLDevice::mem_base_addr_align).
+			std::size_t sub_buffer_alignment() const;
+			/// Returns true if this buffer is a view created by sub_buffer(...).
+			bool is_sub_buffer() const noexcept { return m_parent != nullptr; }
+
 			/** 
 			*	\brief Used for interfacing with Program (this class can be used as kernel argument)
 			*	\return	Returns size of a cl_mem handle.
@@ -1322,6 +2567,11 @@ namespace simple_cl
 			*	\return	Returns pointer to the cl_mem handle.
 			*/
 			const void* arg_data() const { return &m_cl_memory; }
+			/**
+			*	\brief Used for interfacing with Program (this class can be used as kernel argument)
+			*	\return	Returns the process-unique id of this buffer. Unlike the cl_mem handle it is never reused.
+			*/
+			std::uint64_t arg_identity() const noexcept { return m_uid; }
 				
 		private:
 				
@@ -1331,18 +2581,52 @@ namespace simple_cl
 				*	\param length		Length of data in bytes.
 				*	\param offset		Offset into the buffer in bytes.
 				*	\param invalidate	If true, the mapped region is invalidated before writing.
+				*	\param queue	Command queue to enqueue the operation to.
 				*	\return	Returns a Event of the unmap operation.
 			*/
-			Event buf_write(const void* data, std::size_t length = 0ull, std::size_t offset = 0ull, bool invalidate = false);
+			Event buf_write(const EventList& dep_events, const void* data, std::size_t length = 0ull, std::size_t offset = 0ull, bool invalidate = false, const Queue& queue = Queue{});
 				
 			/**
 				*	\brief	Reads some raw data from the OpenCL buffer.
 				*	\param[out] data			Data pointer.
 				*	\param length				Length of data to read in bytes.
 				*	\param offset				Offset into the buffer in bytes.
+				*	\param queue			Command queue to enqueue the operation to.
 				*	\return						Returns a Event of the unmap operation.
 			*/
-			Event buf_read(void* data, std::size_t length = 0ull, std::size_t offset = 0ull) const;
+			Event buf_read(const EventList& dep_events, void* data, std::size_t length = 0ull, std::size_t offset = 0ull, const Queue& queue = Queue{}) const;
+
+			/**
+				*	\brief	Enqueues a non-blocking write of some raw data into the OpenCL buffer.
+				*	\param data			Data pointer.
+				*	\param length		Length of data in bytes.
+				*	\param offset		Offset into the buffer in bytes.
+				*	\param staged		If true, data is copied into staging memory which is released once the command has completed.
+				*	\param queue	Command queue to enqueue the operation to.
+				*	\return	Returns a Event of the write operation.
+			*/
+			Event buf_write_async(const EventList& dep_events, const void* data, std::size_t length, std::size_t offset, bool staged, const Queue& queue);
+
+			/**
+				*	\brief	Enqueues a non-blocking read of some raw data from the OpenCL buffer.
+				*	\param[out] data			Data pointer.
+				*	\param length				Length of data to read in bytes.
+				*	\param offset				Offset into the buffer in bytes.
+				*	\param queue			Command queue to enqueue the operation to.
+				*	\return						Returns a Event of the read operation.
+			*/
+			Event buf_read_async(const EventList& dep_events, void* data, std::size_t length, std::size_t offset, const Queue& queue) const;
+
+			/// Enqueues a write of a rectangular region from strided host memory. Used by write_rect(...).
+			Event buf_write_rect(const EventList& dep_events, const void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking, const Queue& queue);
+			/// Enqueues a read of a rectangular region into strided host memory. Used by read_rect(...).
+			Event buf_read_rect(const EventList& dep_events, void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking, const Queue& queue) const;
+			/// Enqueues a device side copy into another buffer. Used by copy_to(...).
+			Event buf_copy(const EventList& dep_events, Buffer& dst, std::size_t length, std::size_t src_offset, std::size_t dst_offset, const Queue& queue) const;
+			/// Enqueues a device side copy of a rectangular region into another buffer. Used by copy_rect(...).
+			Event buf_copy_rect(const EventList& dep_events, Buffer& dst, const RectLayout& src_layout, const RectLayout& dst_layout, const RectRegion& region, const Queue& queue) const;
+			/// Enqueues a device side fill with a pattern of pattern_size bytes. offset and length are given in bytes. Used by fill(...).
+			Event buf_fill(const EventList& dep_events, const void* pattern, std::size_t pattern_size, std::size_t offset, std::size_t length, const Queue& queue);
 
 			/**
 				*	\brief	Maps the memory region specified by length and offset into the host's address space.
@@ -1350,61 +2634,159 @@ namespace simple_cl
 				*	\param offset		Offset into the buffer in bytes.
 				*	\param write		If true, the region is mapped for write access.
 				*	\param invalidate	Invalidates the buffer region in case of write access. Ignored if write is false.
+				*	\param queue	Command queue to enqueue the operation to.
 				*	\return				Returns a pointer to the mapped memory region. Reading from that region is undefined if write is true, writing is undefined otherwise.
 			*/
-			void* map_buffer(std::size_t length, std::size_t offset, bool write, bool invalidate = false);
+			void* map_buffer(const EventList& dep_events, std::size_t length, std::size_t offset, bool write, bool invalidate = false, const Queue& queue = Queue{});
 
 			/**
 				*	\brief	Unmaps a buffer region mapped previously.
 				*	\param bufptr	Pointer to the beginning (!) of the memory region to be unmapped.
+				*	\param queue	Command queue to enqueue the unmap operation to. Must match the one used for mapping.
 				*	\return			Event of the unmap operation. Blocking behaviour can be achieved if wait is called immediately, e.g.: unmap_buffer(ptr).wait();
 			*/
-			Event unmap_buffer(void* bufptr);
+			Event unmap_buffer(void* bufptr, const Queue& queue = Queue{});
+
+			/// Takes ownership of a sub-buffer handle starting at byte origin of the parent. The parent handle is retained.
+			Buffer(cl_mem sub_buffer, cl_mem parent, std::size_t origin, std::size_t size, const MemoryFlags& flags, const std::shared_ptr<Context>& clstate, void* hostptr);
 
 			cl_mem m_cl_memory;	///< Handle to allocated OpenCL buffer.
+			std::uint64_t m_uid;						///< Process-unique id, see arg_identity().
+			cl_mem m_parent;							///< Parent buffer of a sub-buffer, nullptr otherwise.
+			std::size_t m_origin;						///< Offset of a sub-buffer into its parent in bytes, 0 otherwise.
 			MemoryFlags m_flags;						///< Memory flags used to create the buffer.
 			void* m_hostptr;							///< Host pointer used to create the buffer.
 			std::size_t m_size;							///< Size in bytes of the allocated buffer memory.
 			std::shared_ptr<Context> m_cl_state;		///< Shared pointer to a valid Context instance.
-			std::vector<cl_event> m_event_cache;		///< Used for caching cl_event's in contiguous memory before calling the OpenCL API functions.
 		};
 
-		Event simple_cl::cl::Buffer::write_bytes(const void* data, std::size_t length, std::size_t offset, bool invalidate)
+		inline Event simple_cl::cl::Buffer::write_bytes(const void* data, std::size_t length, std::size_t offset, bool invalidate, const Queue& queue)
+		{
+			return buf_write(EventList{}, data, length, offset, invalidate, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::read_bytes(void* data, std::size_t length, std::size_t offset, const Queue& queue)
+		{
+			return buf_read(EventList{}, data, length, offset, queue);
+		}
+
+		template<typename DepIterator>
+		inline Event simple_cl::cl::Buffer::write_bytes(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t offset, bool invalidate, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_write(EventList{dep_begin, dep_end}, data, length, offset, invalidate, queue);
+		}
+
+		template<typename DepIterator>
+		inline Event simple_cl::cl::Buffer::read_bytes(void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t offset, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_read(EventList{dep_begin, dep_end}, data, length, offset, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::write_bytes_async(const void* data, std::size_t length, std::size_t offset, const Queue& queue)
+		{
+			return buf_write_async(EventList{}, data, length, offset, false, queue);
+		}
+
+		template<typename DepIterator>
+		inline Event simple_cl::cl::Buffer::write_bytes_async(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t offset, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_write_async(EventList{dep_begin, dep_end}, data, length, offset, false, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::write_bytes_staged(const void* data, std::size_t length, std::size_t offset, const Queue& queue)
+		{
+			return buf_write_async(EventList{}, data, length, offset, true, queue);
+		}
+
+		template<typename DepIterator>
+		inline Event simple_cl::cl::Buffer::write_bytes_staged(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t offset, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_write_async(EventList{dep_begin, dep_end}, data, length, offset, true, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::read_bytes_async(void* data, std::size_t length, std::size_t offset, const Queue& queue) const
+		{
+			return buf_read_async(EventList{}, data, length, offset, queue);
+		}
+
+		template<typename DepIterator>
+		inline Event simple_cl::cl::Buffer::read_bytes_async(void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t offset, const Queue& queue) const
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_read_async(EventList{dep_begin, dep_end}, data, length, offset, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::write_rect(const void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking, const Queue& queue)
 		{
-			m_event_cache.clear();
-			return buf_write(data, length, offset, invalidate);
+			return buf_write_rect(EventList{}, data, host_layout, buffer_layout, region, blocking, queue);
 		}
 
-		Event simple_cl::cl::Buffer::read_bytes(void* data, std::size_t length, std::size_t offset)
+		template<typename DepIterator>
+		inline Event simple_cl::cl::Buffer::write_rect(const void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, DepIterator dep_begin, DepIterator dep_end, bool blocking, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_write_rect(EventList{dep_begin, dep_end}, data, host_layout, buffer_layout, region, blocking, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::read_rect(void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking, const Queue& queue) const
 		{
-			m_event_cache.clear();
-			return buf_read(data, length, offset);
+			return buf_read_rect(EventList{}, data, host_layout, buffer_layout, region, blocking, queue);
 		}
 
 		template<typename DepIterator>
-		inline Event simple_cl::cl::Buffer::write_bytes(const void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t offset, bool invalidate)
-		{
-			static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>, Event>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
-			m_event_cache.clear();
-			for(DepIterator it{dep_begin}; it != dep_end; ++it)
-				if(it->m_event)
-					m_event_cache.push_back(it->m_event);
-			return buf_write(data, length, offset, invalidate);
+		inline Event simple_cl::cl::Buffer::read_rect(void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, DepIterator dep_begin, DepIterator dep_end, bool blocking, const Queue& queue) const
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_read_rect(EventList{dep_begin, dep_end}, data, host_layout, buffer_layout, region, blocking, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::copy_to(Buffer& dst, std::size_t length, std::size_t src_offset, std::size_t dst_offset, const Queue& queue) const
+		{
+			return buf_copy(EventList{}, dst, length, src_offset, dst_offset, queue);
+		}
+
+		template<typename DepIterator, typename>
+		inline Event simple_cl::cl::Buffer::copy_to(Buffer& dst, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t src_offset, std::size_t dst_offset, const Queue& queue) const
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_copy(EventList{dep_begin, dep_end}, dst, length, src_offset, dst_offset, queue);
+		}
+
+		inline Event simple_cl::cl::Buffer::copy_rect(Buffer& dst, const RectLayout& src_layout, const RectLayout& dst_layout, const RectRegion& region, const Queue& queue) const
+		{
+			return buf_copy_rect(EventList{}, dst, src_layout, dst_layout, region, queue);
 		}
 
 		template<typename DepIterator>
-		inline Event simple_cl::cl::Buffer::read_bytes(void* data, DepIterator dep_begin, DepIterator dep_end, std::size_t length, std::size_t offset)
-		{
-			static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>, Event>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
-			m_event_cache.clear();
-			for(DepIterator it{dep_begin}; it != dep_end; ++it)
-				if(it->m_event)
-					m_event_cache.push_back(it->m_event);
-			return buf_read(data, length, offset);
+		inline Event simple_cl::cl::Buffer::copy_rect(Buffer& dst, const RectLayout& src_layout, const RectLayout& dst_layout, const RectRegion& region, DepIterator dep_begin, DepIterator dep_end, const Queue& queue) const
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			return buf_copy_rect(EventList{dep_begin, dep_end}, dst, src_layout, dst_layout, region, queue);
+		}
+
+		template<typename T>
+		inline Event simple_cl::cl::Buffer::fill(const T& pattern, std::size_t offset, std::size_t count, const Queue& queue)
+		{
+			static_assert(std::is_standard_layout<T>::value, "[Buffer]: Fill patterns must have standard layout.");
+			static_assert(sizeof(T) <= 128ull && (sizeof(T) & (sizeof(T) - 1ull)) == 0ull, "[Buffer]: Fill pattern size must be a power of two of at most 128 bytes.");
+			return buf_fill(EventList{}, &pattern, sizeof(T), offset * sizeof(T), count * sizeof(T), queue);
+		}
+
+		template<typename T, typename DepIterator, typename>
+		inline Event simple_cl::cl::Buffer::fill(const T& pattern, DepIterator dep_begin, DepIterator dep_end, std::size_t offset, std::size_t count, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Buffer]: Dependency iterators must refer to a collection of Event objects.");
+			static_assert(std::is_standard_layout<T>::value, "[Buffer]: Fill patterns must have standard layout.");
+			static_assert(sizeof(T) <= 128ull && (sizeof(T) & (sizeof(T) - 1ull)) == 0ull, "[Buffer]: Fill pattern size must be a power of two of at most 128 bytes.");
+			return buf_fill(EventList{dep_begin, dep_end}, &pattern, sizeof(T), offset * sizeof(T), count * sizeof(T), queue);
 		}
 
 		template<typename DataIterator>
-		inline Event simple_cl::cl::Buffer::write(DataIterator data_begin, DataIterator data_end, std::size_t offset, bool invalidate)
+		inline Event simple_cl::cl::Buffer::write(DataIterator data_begin, DataIterator data_end, std::size_t offset, bool invalidate, const Queue& queue)
 		{
 			if(m_flags.host_access == HostAccess::ReadOnly || m_flags.host_access == HostAccess::NoAccess)
 				throw std::runtime_error("[Buffer]: Writing to a read only buffer is not allowed.");
@@ -1414,16 +2796,15 @@ namespace simple_cl
 			std::size_t bufoffset = offset * sizeof(elem_t);
 			if(bufoffset + datasize > m_size)
 				throw std::out_of_range("[Buffer]: Buffer write failed. Input offset + length out of range.");
-			m_event_cache.clear();
-			elem_t* bufptr = static_cast<elem_t*>(map_buffer(datasize, bufoffset, true, invalidate));
+			elem_t* bufptr = static_cast<elem_t*>(map_buffer(EventList{}, datasize, bufoffset, true, invalidate, queue));
 			std::size_t bufidx = 0;
 			for(DataIterator it{data_begin}; it != data_end; ++it)
 				bufptr[bufidx++] = *it;
-			return unmap_buffer(static_cast<void*>(bufptr));
+			return unmap_buffer(static_cast<void*>(bufptr), queue);
 		}
 
 		template<typename DataIterator>
-		inline Event simple_cl::cl::Buffer::read(DataIterator data_begin, std::size_t num_elements, std::size_t offset)
+		inline Event simple_cl::cl::Buffer::read(DataIterator data_begin, std::size_t num_elements, std::size_t offset, const Queue& queue)
 		{
 			if(m_flags.host_access == HostAccess::WriteOnly || m_flags.host_access == HostAccess::NoAccess)
 				throw std::runtime_error("[Buffer]: Reading from a write only buffer is not allowed.");
@@ -1433,60 +2814,216 @@ namespace simple_cl
 			std::size_t bufoffset = offset * sizeof(elem_t);
 			if(bufoffset + datasize > m_size)
 				throw std::out_of_range("[Buffer]: Buffer read failed. Input offset + length out of range.");
-			m_event_cache.clear();
-			elem_t* bufptr = static_cast<elem_t*>(map_buffer(datasize, bufoffset, false, false));
+			elem_t* bufptr = static_cast<elem_t*>(map_buffer(EventList{}, datasize, bufoffset, false, false, queue));
 			DataIterator it = data_begin;
 			for(std::size_t i{0ull}; i < num_elements; ++i)
 				*(it++) = bufptr[i];
-			return unmap_buffer(static_cast<void*>(bufptr));
+			return unmap_buffer(static_cast<void*>(bufptr), queue);
 		}
 
 		template<typename DataIterator, typename DepIterator>
-		inline Event simple_cl::cl::Buffer::write(DataIterator data_begin, DataIterator data_end, DepIterator dep_begin, DepIterator dep_end, std::size_t offset, bool invalidate)
+		inline Event simple_cl::cl::Buffer::write(DataIterator data_begin, DataIterator data_end, DepIterator dep_begin, DepIterator dep_end, std::size_t offset, bool invalidate, const Queue& queue)
 		{
 			if(m_flags.host_access == HostAccess::ReadOnly || m_flags.host_access == HostAccess::NoAccess)
 				throw std::runtime_error("[Buffer]: Writing to a read only buffer is not allowed.");
-			static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>, Event>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
-			m_event_cache.clear();
-			for(DepIterator it{dep_begin}; it != dep_end; ++it)
-				if(it->m_event)
-					m_event_cache.push_back(it->m_event);
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
 			using elem_t = typename std::iterator_traits<DataIterator>::value_type;
 			static_assert(std::is_standard_layout<elem_t>::value, "[Buffer]: Types read and written from and to OpenCL buffers must have standard layout.");
 			std::size_t datasize = static_cast<std::size_t>(std::distance(data_begin, data_end)) * sizeof(elem_t);
 			std::size_t bufoffset = offset * sizeof(elem_t);
 			if(bufoffset + datasize > m_size)
 				throw std::out_of_range("[Buffer]: Buffer write failed. Input offset + length out of range.");
-			elem_t* bufptr = static_cast<elem_t*>(map_buffer(datasize, bufoffset, true, invalidate));
+			elem_t* bufptr = static_cast<elem_t*>(map_buffer(EventList{dep_begin, dep_end}, datasize, bufoffset, true, invalidate, queue));
 			std::size_t bufidx = 0;
 			for(DataIterator it{data_begin}; it != data_end; ++it)
 				bufptr[bufidx++] = *it;
-			return unmap_buffer(static_cast<void*>(bufptr));
+			return unmap_buffer(static_cast<void*>(bufptr), queue);
 		}
 
 		template<typename DataIterator, typename DepIterator>
-		inline Event simple_cl::cl::Buffer::read(DataIterator data_begin, std::size_t num_elements, DepIterator dep_begin, DepIterator dep_end, std::size_t offset)
+		inline Event simple_cl::cl::Buffer::read(DataIterator data_begin, std::size_t num_elements, DepIterator dep_begin, DepIterator dep_end, std::size_t offset, const Queue& queue)
 		{
 			if(m_flags.host_access == HostAccess::WriteOnly || m_flags.host_access == HostAccess::NoAccess)
 				throw std::runtime_error("[Buffer]: Reading from a write only buffer is not allowed.");
-			static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>, Event>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
-			m_event_cache.clear();
-			for(DepIterator it{dep_begin}; it != dep_end; ++it)
-				if(it->m_event)
-					m_event_cache.push_back(it->m_event);
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
 			using elem_t = typename std::iterator_traits<DataIterator>::value_type;
 			static_assert(std::is_standard_layout<elem_t>::value, "[Buffer]: Types read and written from and to OpenCL buffers must have standard layout.");
 			std::size_t datasize = num_elements * sizeof(elem_t);
 			std::size_t bufoffset = offset * sizeof(elem_t);
 			if(bufoffset + datasize > m_size)
 				throw std::out_of_range("[Buffer]: Buffer read failed. Input offset + length out of range.");
-			elem_t* bufptr = static_cast<elem_t*>(map_buffer(datasize, bufoffset, false, false));
+			elem_t* bufptr = static_cast<elem_t*>(map_buffer(EventList{dep_begin, dep_end}, datasize, bufoffset, false, false, queue));
 			DataIterator it = data_begin;
 			for(std::size_t i{0ull}; i < num_elements; ++i)
 				*(it++) = bufptr[i];
-			return unmap_buffer(static_cast<void*>(bufptr));
+			return unmap_buffer(static_cast<void*>(bufptr), queue);
 		}
 
+		/**
+		* \brief Pooling allocator handing out device memory from large backing buffers.
+		*
+		* Requests are rounded up to power of two size classes. Each size class carves blocks out of backing buffers ("slabs") of Config::slab_size bytes
+		* and hands them out as sub-buffer views (see Buffer::sub_buffer). Released blocks, including their views, are kept for the next request of the
+		* same size class, so steady state traffic neither calls clCreateBuffer nor clCreateSubBuffer. Requests larger than Config::max_block_size get a
+		* dedicated backing buffer which is released together with the allocation.
+		*
+		* Slabs without live allocations are released once they hold more than Config::max_idle_bytes, or explicitly by trim().
+		* All member functions are thread safe. Handles keep the pool's memory alive and may outlive the BufferPool object.
+		*
+		* \attention Device commands may still use an allocation after its handle was released. A released block is reused right away, so all commands using
+		*			 an allocation must either have completed before its handle dies or be enqueued to the same in-order queue as the commands of the next user.
+		*/
+		class BufferPool
+		{
+			struct State;
+			struct Slab;
+			struct Block;
+		public:
+			/// Pool configuration.
+			struct Config
+			{
+				std::size_t min_block_size;		///< Smallest size class in bytes. Raised to the sub-buffer alignment of the devices if smaller.
+				std::size_t max_block_size;		///< Largest pooled size class in bytes. Larger requests get a dedicated buffer.
+				std::size_t slab_size;			///< Size of the backing buffers in bytes. Raised to the size class if smaller.
+				std::size_t max_idle_bytes;		///< Bytes held in slabs without live allocations before they are released.
+				MemoryFlags flags;				///< Flags of the backing buffers. The host pointer option must be HostPointerOption::None.
+
+				/// Default configuration: 256 B to 16 MiB size classes in 16 MiB slabs, up to 64 MiB idle memory, read write access for host and device.
+				Config() :
+					min_block_size{256ull},
+					max_block_size{16ull << 20},
+					slab_size{16ull << 20},
+					max_idle_bytes{64ull << 20},
+					flags{DeviceAccess::ReadWrite, HostAccess::ReadWrite, HostPointerOption::None}
+				{}
+			};
+
+			/// Pool statistics.
+			struct Stats
+			{
+				std::size_t allocations;		///< Number of allocate() calls.
+				std::size_t live_allocations;	///< Number of live handles.
+				std::size_t buffers_created;	///< Number of backing buffers created (clCreateBuffer calls).
+				std::size_t buffers_released;	///< Number of backing buffers released.
+				std::size_t views_created;		///< Number of sub-buffer views created (clCreateSubBuffer calls).
+				std::size_t reserved_bytes;		///< Device memory currently held by the pool in bytes.
+				std::size_t used_bytes;			///< Bytes of the blocks currently handed out.
+				std::size_t requested_bytes;	///< Bytes currently requested by live handles. The difference to used_bytes is lost to size class rounding.
+			};
+
+			/**
+			* \brief Owning handle of a pool allocation. Returns the memory to the pool when destroyed. Usable as kernel argument.
+			*/
+			class Handle
+			{
+			public:
+				/// Creates an empty handle.
+				Handle() noexcept : m_state{nullptr}, m_block{nullptr}, m_size{0ull} {}
+				/// Destructor. Returns the memory to the pool.
+				~Handle() { reset(); }
+				Handle(const Handle&) = delete;
+				Handle& operator=(const Handle&) = delete;
+				/// Move constructor.
+				Handle(Handle&& other) noexcept;
+				/// Move assignment. Returns the memory held before to the pool.
+				Handle& operator=(Handle&& other) noexcept;
+
+				/// Returns the memory to the pool. The handle is empty afterwards.
+				void reset() noexcept;
+				/// Returns true if the handle holds an allocation.
+				explicit operator bool() const noexcept { return m_block != nullptr; }
+				/// Returns the requested size in bytes. The view may be larger, see Buffer::size().
+				std::size_t size() const noexcept { return m_size; }
+				/// Returns the sub-buffer view of the allocation. It spans the whole block, which is at least size() bytes.
+				Buffer& buffer() const;
+
+				/// Used for interfacing with Program (this class can be used as kernel argument)
+				static constexpr std::size_t arg_size() { return Buffer::arg_size(); }
+				/// Used for interfacing with Program (this class can be used as kernel argument)
+				const void* arg_data() const { return buffer().arg_data(); }
+				/// Used for interfacing with Program (this class can be used as kernel argument)
+				std::uint64_t arg_identity() const { return buffer().arg_identity(); }
+
+			private:
+				friend class BufferPool;
+				Handle(std::shared_ptr<State> state, Block* block, std::size_t size) noexcept : m_state{std::move(state)}, m_block{block}, m_size{size} {}
+
+				std::shared_ptr<State> m_state;	///< Pool state, kept alive by live handles.
+				Block* m_block;					///< Allocated block, nullptr for empty handles.
+				std::size_t m_size;				///< Requested size in bytes.
+			};
+
+			/**
+			* \brief Creates an empty pool. No device memory is allocated before the first request.
+			* \param clstate A valid Context intance used to interface with OpenCL.
+			* \param config Pool configuration.
+			*/
+			BufferPool(const std::shared_ptr<Context>& clstate, const Config& config = Config{});
+
+			/**
+			* \brief Allocates device memory from the pool.
+			* \param size Size of the allocation in bytes.
+			* \return Returns the handle of the allocation.
+			*/
+			Handle allocate(std::size_t size);
+
+			/// Releases all slabs without live allocations.
+			void trim();
+
+			/// Returns a snapshot of the pool statistics.
+			Stats stats() const;
+
+		private:
+			/// Block of a slab. Owns the sub-buffer view, which is created on first use and kept while the slab lives.
+			struct Block
+			{
+				Slab* slab;						///< Slab the block belongs to.
+				std::size_t offset;				///< Offset into the slab in bytes.
+				std::size_t size_class;			///< Index of the size class, constants::BUFFER_POOL_OVERSIZE for dedicated buffers.
+				std::unique_ptr<Buffer> view;	///< Sub-buffer view, nullptr before the first use.
+			};
+
+			/// Slab: backing buffer of a size class, divided into equally sized blocks.
+			struct Slab
+			{
+				Buffer memory;				///< Backing buffer.
+				std::size_t block_size;		///< Size of the blocks in bytes.
+				std::size_t num_free;		///< Number of blocks which are not handed out.
+				std::vector<Block> blocks;	///< Blocks of the slab. Never resized, handles point into it.
+			};
+
+			/// Size class: slabs and free blocks of one block size.
+			struct Bin
+			{
+				std::size_t block_size;						///< Block size of this size class in bytes.
+				std::vector<std::unique_ptr<Slab>> slabs;	///< Slabs of this size class.
+				std::vector<Block*> free_blocks;			///< Blocks available for allocation.
+			};
+
+			/// Shared state of the pool and its handles.
+			struct State
+			{
+				State(const std::shared_ptr<Context>& clstate, const Config& config);
+
+				/// Returns a block to its size class and applies the trim policy. Called by Handle.
+				void release(Block* block, std::size_t size) noexcept;
+				/// Releases slabs without live allocations, largest size classes first, until at most max_idle bytes are idle.
+				void trim_locked(std::size_t max_idle) noexcept;
+				/// Creates a slab for a size class and adds its blocks to the free list.
+				void add_slab(Bin& bin);
+
+				std::shared_ptr<Context> cl_state;							///< Shared pointer to a valid Context instance.
+				Config config;												///< Pool configuration with resolved minimum block size.
+				std::vector<Bin> bins;										///< Size classes, ascending block sizes.
+				std::vector<std::unique_ptr<Slab>> dedicated;				///< Dedicated buffers of oversized allocations.
+				std::size_t idle_bytes;										///< Bytes held in slabs without live allocations.
+				Stats stats;												///< Statistics.
+				mutable std::mutex mutex;									///< Guards the state.
+			};
+
+			std::shared_ptr<State> m_state;	///< Pool state, shared with live handles.
+		};
+
 		#pragma endregion
 			
 		#pragma region images
@@ -1763,12 +3300,13 @@ namespace simple_cl
 			*	\param		blocking		If true, this function blocks until the operation is finished. Otherwise, it returns immediately.
 			*	\attention					Make sure data_ptr stays valid until the operation is finished when blocking is false! Otherwise this may cause access violations.
 			*	\param	default_value	Currently ignored.
+			*	\param	queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return					Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*
 			*	\note default_value is currently ignored until the automatic conversion feature is implemented.
 			*/
-			inline Event write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			inline Event write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 
 			/**
 			*	\brief	Reads data from the image.
@@ -1783,12 +3321,13 @@ namespace simple_cl
 			*	\param		blocking		If true, this function blocks until the operation is finished. Otherwise, it returns immediately.
 			*	\attention					Make sure data_ptr stays valid until the operation is finished when blocking is false! Otherwise this may cause access violations.
 			*	\param		default_value	Currently ignored.
+			*	\param		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return					Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*
 			*	\note default_value is currently ignored until the automatic conversion feature is implemented.
 			*/
-			inline Event read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			inline Event read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 				
 			/**
 			*	\brief	Writes data into the image after waiting on a list of Event's.
@@ -1805,13 +3344,14 @@ namespace simple_cl
 			*	\param	blocking		If true, this function blocks until the operation is finished. Otherwise, it returns immediately.
 			*	\attention				Make sure data_ptr stays valid until the operation is finished when blocking is false! Otherwise this may cause access violations.
 			*	\param	default_value	Currently ignored.
+			*	\param	queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return					Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*
 			*	\note default_value is currently ignored until the automatic conversion feature is implemented.
 			*/
 			template<typename DepIterator>
-			inline Event write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			inline Event write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 				
 			/**
 			*	\brief	Reads data from the image after waiting on a list of Event's.
@@ -1829,13 +3369,14 @@ namespace simple_cl
 			*	\param		blocking		If true, this function blocks until the operation is finished. Otherwise, it returns immediately.
 			*	\attention					Make sure data_ptr stays valid until the operation is finished when blocking is false! Otherwise this may cause access violations.
 			*	\param		default_value	Currently ignored.
+			*	\param		queue		Command queue executing the transfer. Defaults to the queue of the first context device.
 			*
 			*	\return						Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*
 			*	\note default_value is currently ignored until the automatic conversion feature is implemented.
 			*/
 			template<typename DepIterator>
-			inline Event read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			inline Event read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 
 			/**
 			*	\brief Represents a color value for e.g. filling an image with a constant color.
@@ -1870,19 +3411,23 @@ namespace simple_cl
 				*	\brief				Fills the specified image region with a constant color.
 				*	\param color		Constant fill color.
 				*	\param img_region	Region to fill within the image.
+				*	\param queue	Command queue executing the fill. Defaults to the queue of the first context device.
 				*	\return				Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*/
-			inline Event fill(const FillColor& color, const ImageRegion& img_region);
+			inline Event fill(const FillColor& color, const ImageRegion& img_region, const Queue& queue = Queue{});
 
 			/**
 				*	\brief				Fills the specified image region with a constant color after waiting on a list of Event's.
 				*	\tparam	DepIterator	Some iterator type fulfilling the LegacyInputIterator named requirement and referring to Event objects.
 				*	\param color		Constant fill color.
 				*	\param img_region	Region to fill within the image.
+				*	\param dep_begin	Begin iterator of Event collection.
+				*	\param dep_end		End iterator of Event collection.
+				*	\param queue	Command queue executing the fill. Defaults to the queue of the first context device.
 				*	\return				Returns a Event object which can be waited upon either by other OpenCL operations or explicitely to block until the data is synchronized with OpenCL.
 			*/
 			template<typename DepIterator>
-			inline Event fill(const FillColor& color, const ImageRegion& img_region, DepIterator dep_begin, DepIterator dep_end);
+			inline Event fill(const FillColor& color, const ImageRegion& img_region, DepIterator dep_begin, DepIterator dep_end, const Queue& queue = Queue{});
 
 			/**
 			*	\brief Used for interfacing with Program (this class can be used as kernel argument)
@@ -1894,65 +3439,60 @@ namespace simple_cl
 			*	\return	Returns pointer to the cl_mem handle.
 			*/
 			const void* arg_data() const { return &m_image; }
+			/**
+			*	\brief Used for interfacing with Program (this class can be used as kernel argument)
+			*	\return	Returns the process-unique id of this image. Unlike the cl_mem handle it is never reused.
+			*/
+			std::uint64_t arg_identity() const noexcept { return m_uid; }
 		private:
 			/** 
 			*	\brief	Implementation of image write operations (using clEnqueueMapImage).
 			*	\bug	Seems to be buggy for image2D arrays. No matter how I set origin[2], it always maps the first array slice.
 			*/
-			Event img_write_mapped(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool invalidate = false, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			Event img_write_mapped(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool invalidate = false, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 			/**
 			*	\brief	Implementation of image read operations (using clEnqueueMapImage).
 			*	\bug	Seems to be buggy for image2D arrays. No matter how I set origin[2], it always maps the first array slice.
 			*/
-			Event img_read_mapped(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			Event img_read_mapped(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, void* data_ptr, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 			/// Implementation of image write operations.
-			Event img_write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			Event img_write(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 			///	Implementation of image read operations.
-			Event img_read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros);
+			Event img_read(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking = true, ChannelDefaultValue default_value = ChannelDefaultValue::Zeros, const Queue& queue = Queue{});
 			/// Implementation of image fill operation.
-			Event img_fill(const FillColor& color, const ImageRegion& img_region);
+			Event img_fill(const EventList& dep_events, const FillColor& color, const ImageRegion& img_region, const Queue& queue = Queue{});
 
 			/// Checks whether the host format matches the image format.
 			bool match_format(const HostFormat& format);
 				
 			cl_mem m_image;							///< Stores the OpenCL image object handle.
+			std::uint64_t m_uid;					///< Process-unique id, see arg_identity().
 			ImageDesc m_image_desc;					///< Image description as passed to the constructor.
-			std::vector<cl_event> m_event_cache;	///< Used to cache cl_event's in contiguous memory before calling the API functions.
 			std::shared_ptr<Context> m_cl_state;	///< Shared pointer to a valid instance of Context.
 		};
 
-		inline Event simple_cl::cl::Image::write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking, ChannelDefaultValue default_value)
+		inline Event simple_cl::cl::Image::write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking, ChannelDefaultValue default_value, const Queue& queue)
 		{
-			m_event_cache.clear();
-			return img_write(img_region, format, data_ptr, blocking, default_value);
+			return img_write(EventList{}, img_region, format, data_ptr, blocking, default_value, queue);
 		}
 
-		inline Event simple_cl::cl::Image::read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking, ChannelDefaultValue default_value)
+		inline Event simple_cl::cl::Image::read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking, ChannelDefaultValue default_value, const Queue& queue)
 		{
-			m_event_cache.clear();
-			return img_read(img_region, format, data_ptr, blocking, default_value);
+			return img_read(EventList{}, img_region, format, data_ptr, blocking, default_value, queue);
 		}
 
 		template<typename DepIterator>
-		inline Event simple_cl::cl::Image::write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking, ChannelDefaultValue default_value)
-		{
-			static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>, Event>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
-			m_event_cache.clear();
-			for(DepIterator it{dep_begin}; it != dep_end; ++it)
-				if(it->m_event)
-					m_event_cache.push_back(it->m_event);
-			return img_write_mapped(img_region, format, data_ptr, default_value);
+		inline Event simple_cl::cl::Image::write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking, ChannelDefaultValue default_value, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
+			return img_write(EventList{dep_begin, dep_end}, img_region, format, data_ptr, blocking, default_value, queue);
 		}
 
 		template<typename DepIterator>
-		inline Event simple_cl::cl::Image::read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking, ChannelDefaultValue default_value)
-		{
-			static_assert(std::is_same<meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>, Event>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
-			m_event_cache.clear();
-			for(DepIterator it{dep_begin}; it != dep_end; ++it)
-				if(it->m_event)
-					m_event_cache.push_back(it->m_event);
-			return img_read_mapped(img_region, format, data_ptr, default_value);
+		inline Event simple_cl::cl::Image::read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, DepIterator dep_begin, DepIterator dep_end, bool blocking, ChannelDefaultValue default_value, const Queue& queue)
+		{
+			static_assert(std::is_base_of<Event, meta::bare_type_t<typename std::iterator_traits<DepIterator>::value_type>>::value, "[Image]: Dependency iterators must refer to a collection of Event objects.");
+			return img_read(EventList{dep_begin, dep_end}, img_region, format, data_ptr, blocking, default_value, queue);
 		}
 
 		inline std::size_t Image::get_image_channel_type_size(const Image::ImageChannelType type)
@@ -2014,19 +3554,15 @@ namespace simple_cl
 			return constants::INVALID_COLOR_CHANNEL_INDEX;
 		}
 
-		inline Event Image::fill(const Image::FillColor& color, const Image::ImageRegion& img_region)
+		inline Event Image::fill(const Image::FillColor& color, const Image::ImageRegion& img_region, const Queue& queue)
 		{
-			m_event_cache.clear();
-			return img_fill(color, img_region);
+			return img_fill(EventList{}, color, img_region, queue);
 		}
 
 		template<typename DepIterator>
-		inline Event Image::fill(const Image::FillColor& color, const Image::ImageRegion& img_region, DepIterator dep_begin, DepIterator dep_end)
+		inline Event Image::fill(const Image::FillColor& color, const Image::ImageRegion& img_region, DepIterator dep_begin, DepIterator dep_end, const Queue& queue)
 		{
-			m_event_cache.clear();
-			for(DepIterator it{dep_begin}; it != dep_end; ++it)
-				m_event_cache.push_back(it->m_event);
-			return img_fill(color, img_region);
+			return img_fill(EventList{dep_begin, dep_end}, color, img_region, queue);
 		}
 
 		// global operators
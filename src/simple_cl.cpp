@@ -23,6 +23,27 @@ unsigned int simple_cl::util::get_cl_version_num(const std::string& str)
 	return version_major * 100u + version_minor * 10u;
 }
 
+std::uint64_t simple_cl::util::fnv1a_64(const void* data, std::size_t length, std::uint64_t hash)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i = 0ull; i < length; ++i)
+		hash = (hash ^ std::uint64_t{bytes[i]}) * FNV1A_64_PRIME;
+	return hash;
+}
+
+std::string simple_cl::util::unique_temp_suffix()
+{
+	// the process token tells apart processes, the counter calls within a process
+	static const std::uint64_t process_token{[]() {
+		std::random_device device;
+		return (std::uint64_t{device()} << 32) ^ std::uint64_t{device()};
+	}()};
+	static std::atomic<std::uint64_t> counter{0ull};
+	std::ostringstream suffix;
+	suffix << std::hex << process_token << '.' << counter.fetch_add(1ull);
+	return suffix.str();
+}
+
 #pragma endregion
 
 // -------------------------------------------- NAMESPACE simple_cl::cl -------------------------------------
@@ -30,23 +51,403 @@ unsigned int simple_cl::util::get_cl_version_num(const std::string& str)
 #pragma region cl
 #pragma region class Context
 // ---------------------- class Context
+namespace
+{
+	// Returns a copy of the platform list which only contains devices of the given type. Platforms without such devices are omitted.
+	std::vector<simple_cl::cl::Context::CLPlatform> filter_platforms_by_device_type(const std::vector<simple_cl::cl::Context::CLPlatform>& platforms, simple_cl::cl::DeviceType device_type)
+	{
+		std::vector<simple_cl::cl::Context::CLPlatform> filtered_platforms;
+		for(const auto& platform : platforms)
+		{
+			simple_cl::cl::Context::CLPlatform filtered_platform{platform};
+			filtered_platform.devices.clear();
+			for(const auto& device : platform.devices)
+				if(device.device_type & static_cast<cl_device_type>(device_type))
+					filtered_platform.devices.push_back(device);
+			if(filtered_platform.devices.size() > 0)
+				filtered_platforms.push_back(std::move(filtered_platform));
+		}
+		return filtered_platforms;
+	}
+
+	// Process-wide snapshot of the available platforms and devices, see Context::read_platform_and_device_info().
+	struct DeviceInfoSnapshot
+	{
+		std::mutex mutex;
+		std::shared_ptr<const std::vector<simple_cl::cl::Context::CLPlatform>> platforms;	///< All suitable platforms and devices of all types, nullptr until first use.
+		std::string cache_file;																///< On-disk device info cache, disabled if empty.
+	};
+
+	DeviceInfoSnapshot& device_info_snapshot()
+	{
+		static DeviceInfoSnapshot snapshot;
+		return snapshot;
+	}
+
+	// Device info as stored in the on-disk cache. Unsuitable devices are cached as well so they are not queried again.
+	struct CachedDeviceRecord
+	{
+		bool suitable = false;
+		simple_cl::cl::Context::CLDevice device;
+	};
+
+	constexpr const char* DEVICE_INFO_CACHE_HEADER{"simple_cl device info cache v1"};
+
+	// Applies visitor to every cacheable CLDevice member. Device ids are process specific and therefore excluded.
+	template<typename Device, typename Visitor>
+	void visit_cached_device_fields(Device& dev, const Visitor& visitor)
+	{
+		visitor(dev.device_type); visitor(dev.queue_properties); visitor(dev.vendor_id); visitor(dev.max_compute_units);
+		visitor(dev.max_work_item_dimensions); visitor(dev.max_work_item_sizes); visitor(dev.max_work_group_size); visitor(dev.max_mem_alloc_size);
+		visitor(dev.image2d_max_width); visitor(dev.image2d_max_height); visitor(dev.image3d_max_width); visitor(dev.image3d_max_height);
+		visitor(dev.image3d_max_depth); visitor(dev.image_max_buffer_size); visitor(dev.image_max_array_size); visitor(dev.max_samplers);
+		visitor(dev.max_parameter_size); visitor(dev.mem_base_addr_align); visitor(dev.global_mem_cacheline_size); visitor(dev.global_mem_cache_size);
+		visitor(dev.global_mem_size); visitor(dev.max_constant_buffer_size); visitor(dev.max_constant_args); visitor(dev.local_mem_size);
+		visitor(dev.little_endian); visitor(dev.name); visitor(dev.vendor); visitor(dev.driver_version); visitor(dev.device_profile);
+		visitor(dev.device_version); visitor(dev.device_version_num); visitor(dev.device_extensions); visitor(dev.printf_buffer_size);
+		visitor(dev.partition_max_sub_devices); visitor(dev.partition_affinity_domains);
+	}
+
+	// Writes one value per line.
+	struct CacheFieldWriter
+	{
+		std::ostream& os;
+		template<typename T>
+		void operator()(const T& value) const { os << value << '\n'; }
+		void operator()(const std::string& value) const
+		{
+			std::string line{value};
+			std::replace(line.begin(), line.end(), '\n', ' ');
+			os << line << '\n';
+		}
+		void operator()(const std::vector<std::size_t>& values) const
+		{
+			os << values.size();
+			for(std::size_t v : values)
+				os << ' ' << v;
+			os << '\n';
+		}
+	};
+
+	// Reads values written by CacheFieldWriter. Errors are reported via the stream state.
+	struct CacheFieldReader
+	{
+		std::istream& is;
+		template<typename T>
+		void operator()(T& value) const
+		{
+			is >> value;
+			is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		}
+		void operator()(std::string& value) const { std::getline(is, value); }
+		void operator()(std::vector<std::size_t>& values) const
+		{
+			std::size_t count{0ull};
+			is >> count;
+			values.assign(is ? count : 0ull, 0ull);
+			for(std::size_t& v : values)
+				is >> v;
+			is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+		}
+	};
+
+	// Returns the device records of the cache file. A missing or malformed file yields an empty cache.
+	std::unordered_map<std::string, CachedDeviceRecord> load_device_info_cache(const std::string& path)
+	{
+		std::unordered_map<std::string, CachedDeviceRecord> records;
+		std::ifstream file(path);
+		std::string line;
+		if(!std::getline(file, line) || line != DEVICE_INFO_CACHE_HEADER)
+			return records;
+		const CacheFieldReader reader{file};
+		while(std::getline(file, line))
+		{
+			if(line == "end")
+				return records;
+			// key: platform name, device name, driver version
+			std::string device_name, driver_version;
+			std::getline(file, device_name);
+			std::getline(file, driver_version);
+			CachedDeviceRecord record;
+			reader(record.suitable);
+			if(record.suitable)
+				visit_cached_device_fields(record.device, reader);
+			if(!file)
+				break;
+			records[line + '\n' + device_name + '\n' + driver_version] = std::move(record);
+		}
+		// no end marker, file is truncated or malformed
+		return std::unordered_map<std::string, CachedDeviceRecord>{};
+	}
+
+	// Writes all device records to the cache file. Failures are ignored, the cache is an optimization only.
+	void store_device_info_cache(const std::string& path, const std::unordered_map<std::string, CachedDeviceRecord>& records)
+	{
+		// write to a temporary file first so that concurrent writers never interleave and readers never see partial files
+		const std::string temp_path{path + ".tmp" + simple_cl::util::unique_temp_suffix()};
+		{
+			std::ofstream file(temp_path, std::ios::trunc);
+			if(!file)
+				return;
+			const CacheFieldWriter writer{file};
+			file << DEVICE_INFO_CACHE_HEADER << '\n';
+			for(const auto& record : records)
+			{
+				file << record.first << '\n';
+				writer(record.second.suitable);
+				if(record.second.suitable)
+					visit_cached_device_fields(record.second.device, writer);
+			}
+			file << "end" << '\n';
+			if(!file)
+			{
+				file.close();
+				std::remove(temp_path.c_str());
+				return;
+			}
+		}
+		if(std::rename(temp_path.c_str(), path.c_str()) != 0)
+			std::remove(temp_path.c_str());
+	}
+
+	std::string device_info_string(cl_device_id device_id, cl_device_info param)
+	{
+		std::size_t infostrlen{0ull};
+		CL_EX(clGetDeviceInfo(device_id, param, 0ull, nullptr, &infostrlen));
+		std::unique_ptr<char[]> infostring(new char[infostrlen]);
+		CL_EX(clGetDeviceInfo(device_id, param, infostrlen, infostring.get(), nullptr));
+		return std::string{infostring.get()};
+	}
+
+	// Kernels used by Context::rank_devices() to measure global memory bandwidth and arithmetic throughput.
+	constexpr const char* DEVICE_PROBE_SOURCE{R"(
+		__kernel void probe_copy(__global const float4* in, __global float4* out)
+		{
+			size_t i = get_global_id(0);
+			out[i] = in[i];
+		}
+
+		__kernel void probe_mad(__global float* out, float a)
+		{
+			float x = (float)get_global_id(0);
+			float y = a;
+			for(int i = 0; i < 256; ++i)
+			{
+				x = mad(x, y, 0.5f);
+				y = mad(y, x, -0.5f);
+			}
+			out[get_global_id(0)] = x + y;
+		}
+	)"};
+	constexpr double DEVICE_PROBE_FLOPS_PER_ITEM{256.0 * 2.0 * 2.0};
+
+	const char* device_type_string(cl_device_type device_type)
+	{
+		if(device_type & CL_DEVICE_TYPE_GPU)
+			return "GPU";
+		if(device_type & CL_DEVICE_TYPE_CPU)
+			return "CPU";
+		if(device_type & CL_DEVICE_TYPE_ACCELERATOR)
+			return "Accelerator";
+		return "Other";
+	}
+}
+
 // factory function
-std::shared_ptr<simple_cl::cl::Context> simple_cl::cl::Context::createInstance(std::size_t platform_index, std::size_t device_index)
+std::shared_ptr<simple_cl::cl::Context> simple_cl::cl::Context::createInstance(std::size_t platform_index, std::size_t device_index, DeviceType device_type, QueueProperties queue_properties)
+{
+	return std::shared_ptr<Context>(new Context{read_platform_and_device_info(device_type), platform_index, {device_index}, queue_properties});
+}
+
+std::shared_ptr<simple_cl::cl::Context> simple_cl::cl::Context::createInstance(const std::vector<DeviceType>& device_type_preference, QueueProperties queue_properties)
+{
+	std::vector<CLPlatform> all_platforms{read_platform_and_device_info(DeviceType::All)};
+	for(DeviceType device_type : device_type_preference)
+	{
+		std::vector<CLPlatform> platforms{filter_platforms_by_device_type(all_platforms, device_type)};
+		// filtered platforms always contain at least one device
+		if(platforms.size() > 0ull)
+			return std::shared_ptr<Context>(new Context{std::move(platforms), 0ull, {0ull}, queue_properties});
+	}
+	throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: No suitable OpenCL 1.2 device of any preferred type found.");
+}
+
+std::shared_ptr<simple_cl::cl::Context> simple_cl::cl::Context::createInstance(const WorkloadProfile& profile, DeviceType device_type, QueueProperties queue_properties)
+{
+	std::vector<DeviceScore> scores{rank_devices(profile, device_type)};
+	if(scores.size() == 0ull)
+		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: No suitable OpenCL 1.2 device found.");
+	return std::shared_ptr<Context>(new Context{read_platform_and_device_info(device_type), scores.front().platform_index, {scores.front().device_index}, queue_properties});
+}
+
+std::vector<simple_cl::cl::Context::DeviceScore> simple_cl::cl::Context::rank_devices(const WorkloadProfile& profile, DeviceType device_type)
+{
+	std::vector<CLPlatform> platforms{read_platform_and_device_info(device_type)};
+	std::vector<DeviceScore> scores;
+	std::vector<const CLDevice*> devices;
+	for(std::size_t p = 0ull; p < platforms.size(); ++p)
+		for(std::size_t d = 0ull; d < platforms[p].devices.size(); ++d)
+		{
+			scores.push_back(DeviceScore{p, d, 0.0, 0.0, 0.0});
+			devices.push_back(&platforms[p].devices[d]);
+			if(profile.probe)
+			{
+				// a device that fails to run the probes is ranked by its static properties only
+				try
+				{
+					probe_device(p, d, device_type, scores.back());
+				}
+				catch(const std::exception& e)
+				{
+					scores.back().probe_bandwidth = 0.0;
+					scores.back().probe_flops = 0.0;
+					std::cerr << "[Context]: Probing device " << d << " of platform " << p << " failed: " << e.what() << std::endl;
+				}
+			}
+		}
+
+	// normalize every metric to the best candidate so that the weights express relative importance only
+	double max_compute_units{0.0}, max_global_mem_size{0.0}, max_local_mem_size{0.0}, max_work_group_size{0.0}, max_bandwidth{0.0}, max_flops{0.0};
+	for(std::size_t i = 0ull; i < scores.size(); ++i)
+	{
+		max_compute_units = std::max(max_compute_units, static_cast<double>(devices[i]->max_compute_units));
+		max_global_mem_size = std::max(max_global_mem_size, static_cast<double>(devices[i]->global_mem_size));
+		max_local_mem_size = std::max(max_local_mem_size, static_cast<double>(devices[i]->local_mem_size));
+		max_work_group_size = std::max(max_work_group_size, static_cast<double>(devices[i]->max_work_group_size));
+		max_bandwidth = std::max(max_bandwidth, scores[i].probe_bandwidth);
+		max_flops = std::max(max_flops, scores[i].probe_flops);
+	}
+	auto normalized = [](double value, double max_value) { return max_value > 0.0 ? value / max_value : 0.0; };
+	for(std::size_t i = 0ull; i < scores.size(); ++i)
+	{
+		scores[i].score =
+			profile.compute_units_weight * normalized(static_cast<double>(devices[i]->max_compute_units), max_compute_units) +
+			profile.global_mem_size_weight * normalized(static_cast<double>(devices[i]->global_mem_size), max_global_mem_size) +
+			profile.local_mem_size_weight * normalized(static_cast<double>(devices[i]->local_mem_size), max_local_mem_size) +
+			profile.work_group_size_weight * normalized(static_cast<double>(devices[i]->max_work_group_size), max_work_group_size);
+		if(profile.probe)
+			scores[i].score +=
+				profile.probe_bandwidth_weight * normalized(scores[i].probe_bandwidth, max_bandwidth) +
+				profile.probe_compute_weight * normalized(scores[i].probe_flops, max_flops);
+	}
+	std::stable_sort(scores.begin(), scores.end(), [](const DeviceScore& a, const DeviceScore& b) { return a.score > b.score; });
+	return scores;
+}
+
+void simple_cl::cl::Context::probe_device(std::size_t platform_index, std::size_t device_index, DeviceType device_type, DeviceScore& score)
+{
+	// quiet context, ranking would otherwise print one initialization banner per candidate device
+	std::shared_ptr<Context> context{new Context{read_platform_and_device_info(device_type), platform_index, {device_index}, QueueProperties::None, false}};
+	const CLDevice& device = context->get_selected_device();
+	const std::size_t local_size{std::min(std::size_t{64ull}, device.max_work_group_size)};
+	// 16 MiB per buffer or less if the device can't allocate that much, rounded to whole work groups
+	const std::size_t buffer_size{std::min(std::size_t{16ull << 20}, static_cast<std::size_t>(device.max_mem_alloc_size / 4ull))};
+	const std::size_t float4_size{4ull * sizeof(cl_float)};
+	const std::size_t copy_items{(buffer_size / float4_size) / local_size * local_size};
+	const std::size_t mad_items{static_cast<std::size_t>(device.max_compute_units) * 1024ull / local_size * local_size};
+	if(copy_items == 0ull || mad_items == 0ull)
+		return;
+
+	Program program{DEVICE_PROBE_SOURCE, "", context};
+	const MemoryFlags flags{DeviceAccess::ReadWrite, HostAccess::NoAccess, HostPointerOption::None};
+	Buffer in{copy_items * float4_size, flags, context};
+	Buffer out{std::max(copy_items * float4_size, mad_items * sizeof(cl_float)), flags, context};
+	const Program::ExecParams copy_params{1ull, {0ull, 0ull, 0ull}, {copy_items, 1ull, 1ull}, {local_size, 1ull, 1ull}, Queue{}};
+	const Program::ExecParams mad_params{1ull, {0ull, 0ull, 0ull}, {mad_items, 1ull, 1ull}, {local_size, 1ull, 1ull}, Queue{}};
+
+	// the first invocation of each kernel is a warm-up
+	using clock = std::chrono::steady_clock;
+	program("probe_copy", copy_params, in, out).wait();
+	clock::time_point start{clock::now()};
+	program("probe_copy", copy_params, in, out).wait();
+	double seconds{std::chrono::duration<double>(clock::now() - start).count()};
+	if(seconds > 0.0)
+		score.probe_bandwidth = 2.0 * static_cast<double>(copy_items * float4_size) / seconds;
+
+	program("probe_mad", mad_params, out, 1.0001f).wait();
+	start = clock::now();
+	program("probe_mad", mad_params, out, 1.0001f).wait();
+	seconds = std::chrono::duration<double>(clock::now() - start).count();
+	if(seconds > 0.0)
+		score.probe_flops = DEVICE_PROBE_FLOPS_PER_ITEM * static_cast<double>(mad_items) / seconds;
+}
+
+std::shared_ptr<simple_cl::cl::Context> simple_cl::cl::Context::createInstance(std::size_t platform_index, const std::vector<std::size_t>& device_indices, DeviceType device_type, QueueProperties queue_properties)
+{
+	return std::shared_ptr<Context>(new Context{read_platform_and_device_info(device_type), platform_index, device_indices, queue_properties});
+}
+
+std::shared_ptr<simple_cl::cl::Context> simple_cl::cl::Context::createPlatformInstance(std::size_t platform_index, DeviceType device_type, QueueProperties queue_properties)
+{
+	std::vector<CLPlatform> platforms{read_platform_and_device_info(device_type)};
+	if(platform_index >= platforms.size())
+		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Platform index out of range.");
+	std::vector<std::size_t> device_indices(platforms[platform_index].devices.size());
+	for(std::size_t d = 0ull; d < device_indices.size(); ++d)
+		device_indices[d] = d;
+	return std::shared_ptr<Context>(new Context{std::move(platforms), platform_index, device_indices, queue_properties});
+}
+
+std::vector<std::shared_ptr<simple_cl::cl::Context>> simple_cl::cl::Context::createSubDeviceInstances(std::size_t platform_index, std::size_t device_index, const DevicePartition& partition, DeviceType device_type, QueueProperties queue_properties)
+{
+	std::vector<CLPlatform> platforms{read_platform_and_device_info(device_type)};
+	if(platform_index >= platforms.size())
+		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Platform index out of range.");
+	if(device_index >= platforms[platform_index].devices.size())
+		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Device index out of range.");
+	std::vector<CLDevice> sub_devices{create_sub_devices(platforms[platform_index].devices[device_index], partition)};
+
+	std::vector<std::shared_ptr<Context>> contexts;
+	std::size_t s = 0ull;
+	try
+	{
+		for(; s < sub_devices.size(); ++s)
+		{
+			std::vector<CLPlatform> sub_platforms{platforms};
+			sub_platforms[platform_index].devices = {sub_devices[s]};
+			contexts.push_back(std::shared_ptr<Context>(new Context{std::move(sub_platforms), platform_index, {0ull}, queue_properties}));
+		}
+	}
+	catch(...)
+	{
+		// a failed Context releases its own sub-device, the remaining ones are still owned by us
+		for(++s; s < sub_devices.size(); ++s)
+			CL(clReleaseDevice(sub_devices[s].device_id));
+		throw;
+	}
+	return contexts;
+}
+
+std::shared_ptr<simple_cl::cl::Context> simple_cl::cl::Context::createSubDeviceInstance(std::size_t platform_index, std::size_t device_index, const DevicePartition& partition, DeviceType device_type, QueueProperties queue_properties)
 {
-	return std::shared_ptr<Context>(new Context{platform_index, device_index});
+	std::vector<CLPlatform> platforms{read_platform_and_device_info(device_type)};
+	if(platform_index >= platforms.size())
+		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Platform index out of range.");
+	if(device_index >= platforms[platform_index].devices.size())
+		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Device index out of range.");
+	platforms[platform_index].devices = create_sub_devices(platforms[platform_index].devices[device_index], partition);
+	std::vector<std::size_t> device_indices(platforms[platform_index].devices.size());
+	for(std::size_t d = 0ull; d < device_indices.size(); ++d)
+		device_indices[d] = d;
+	// the Context releases all selected sub-devices, even if construction fails
+	return std::shared_ptr<Context>(new Context{std::move(platforms), platform_index, device_indices, queue_properties});
 }
 
-simple_cl::cl::Context::Context(std::size_t platform_index, std::size_t device_index) :
-	m_available_platforms{std::move(read_platform_and_device_info())},
+simple_cl::cl::Context::Context(std::vector<CLPlatform> available_platforms, std::size_t platform_index, const std::vector<std::size_t>& device_indices, QueueProperties queue_properties, bool verbose) :
+	m_available_platforms{std::move(available_platforms)},
 	m_selected_platform_index{0},
-	m_selected_device_index{0},
+	m_selected_devices{},
 	m_context{nullptr},
-	m_command_queue{nullptr},
-	m_cl_ex_holder{nullptr}		
+	m_command_queues{},
+	m_additional_queues{},
+	m_additional_queues_mutex{},
+	m_cl_ex_holder{nullptr},
+	m_program_registry{},
+	m_program_registry_mutex{}
 {
 	try
 	{
-		init_cl_instance(platform_index, device_index);
+		init_cl_instance(platform_index, device_indices, queue_properties, verbose);
 	}
 	catch(...)
 	{
@@ -64,12 +465,25 @@ simple_cl::cl::Context::~Context()
 simple_cl::cl::Context::Context(Context&& other) noexcept :
 	m_available_platforms(std::move(other.m_available_platforms)),
 	m_selected_platform_index{other.m_selected_platform_index},
-	m_selected_device_index{other.m_selected_device_index},
+	m_selected_devices{std::move(other.m_selected_devices)},
 	m_context{other.m_context},
-	m_command_queue{other.m_command_queue},
-	m_cl_ex_holder{std::move(other.m_cl_ex_holder)}
+	m_command_queues{std::move(other.m_command_queues)},
+	m_additional_queues{},
+	m_additional_queues_mutex{},
+	m_cl_ex_holder{std::move(other.m_cl_ex_holder)},
+	m_program_registry{},
+	m_program_registry_mutex{}
 {
-	other.m_command_queue = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(other.m_additional_queues_mutex);
+		m_additional_queues = std::move(other.m_additional_queues);
+		other.m_additional_queues.clear();
+	}
+	std::lock_guard<std::mutex> lock(other.m_program_registry_mutex);
+	m_program_registry = std::move(other.m_program_registry);
+	other.m_program_registry.clear();
+	other.m_selected_devices.clear();
+	other.m_command_queues.clear();
 	other.m_context = nullptr;
 	other.m_cl_ex_holder.ex_msg = nullptr;
 }
@@ -83,10 +497,23 @@ simple_cl::cl::Context& simple_cl::cl::Context::operator=(Context&& other) noexc
 
 	m_available_platforms = std::move(other.m_available_platforms);
 	m_selected_platform_index = other.m_selected_platform_index;
-	m_selected_device_index = other.m_selected_device_index;
+	std::swap(m_selected_devices, other.m_selected_devices);
 	std::swap(m_context, other.m_context);
-	std::swap(m_command_queue, other.m_command_queue);
+	std::swap(m_command_queues, other.m_command_queues);
 	std::swap(m_cl_ex_holder, other.m_cl_ex_holder);
+	{
+		std::lock(m_additional_queues_mutex, other.m_additional_queues_mutex);
+		std::lock_guard<std::mutex> lock(m_additional_queues_mutex, std::adopt_lock);
+		std::lock_guard<std::mutex> other_lock(other.m_additional_queues_mutex, std::adopt_lock);
+		std::swap(m_additional_queues, other.m_additional_queues);
+	}
+	{
+		std::lock(m_program_registry_mutex, other.m_program_registry_mutex);
+		std::lock_guard<std::mutex> lock(m_program_registry_mutex, std::adopt_lock);
+		std::lock_guard<std::mutex> other_lock(other.m_program_registry_mutex, std::adopt_lock);
+		m_program_registry = std::move(other.m_program_registry);
+		other.m_program_registry.clear();
+	}
 
 	return *this;
 }
@@ -99,8 +526,11 @@ void simple_cl::cl::Context::print_selected_platform_info() const
 
 void simple_cl::cl::Context::print_selected_device_info() const
 {
-	std::cout << "===== Selected OpenCL device =====" << std::endl;
-	std::cout << m_available_platforms[m_selected_platform_index].devices[m_selected_device_index];
+	for(std::size_t d = 0ull; d < m_selected_devices.size(); ++d)
+	{
+		std::cout << "===== Selected OpenCL device " << d << " =====" << std::endl;
+		std::cout << m_selected_devices[d];
+	}
 }
 
 void simple_cl::cl::Context::print_platform_and_device_info(const std::vector<Context::CLPlatform>& available_platforms)
@@ -133,8 +563,42 @@ void simple_cl::cl::Context::print_platform_and_device_info()
 	}
 }
 
-std::vector<simple_cl::cl::Context::CLPlatform> simple_cl::cl::Context::read_platform_and_device_info()
+std::vector<simple_cl::cl::Context::CLPlatform> simple_cl::cl::Context::read_platform_and_device_info(DeviceType device_type)
+{
+	DeviceInfoSnapshot& snapshot = device_info_snapshot();
+	std::shared_ptr<const std::vector<CLPlatform>> platforms;
+	{
+		// concurrent first callers wait for a single enumeration
+		std::lock_guard<std::mutex> lock(snapshot.mutex);
+		if(!snapshot.platforms)
+			snapshot.platforms = std::make_shared<const std::vector<CLPlatform>>(query_platform_and_device_info(snapshot.cache_file));
+		platforms = snapshot.platforms;
+	}
+	return filter_platforms_by_device_type(*platforms, device_type);
+}
+
+void simple_cl::cl::Context::refresh_platform_and_device_info()
+{
+	DeviceInfoSnapshot& snapshot = device_info_snapshot();
+	std::lock_guard<std::mutex> lock(snapshot.mutex);
+	snapshot.platforms.reset();
+}
+
+void simple_cl::cl::Context::set_device_info_cache_file(const std::string& path)
+{
+	DeviceInfoSnapshot& snapshot = device_info_snapshot();
+	std::lock_guard<std::mutex> lock(snapshot.mutex);
+	snapshot.cache_file = path;
+}
+
+std::vector<simple_cl::cl::Context::CLPlatform> simple_cl::cl::Context::query_platform_and_device_info(const std::string& cache_file)
 {
+	// device records from the on-disk cache, keyed by platform name, device name and driver version
+	std::unordered_map<std::string, CachedDeviceRecord> cached_devices;
+	bool cache_outdated{false};
+	if(!cache_file.empty())
+		cached_devices = load_device_info_cache(cache_file);
+
 	// output vector
 	std::vector<CLPlatform> available_platforms;
 	// query number of platforms available
@@ -184,135 +648,47 @@ std::vector<simple_cl::cl::Context::CLPlatform> simple_cl::cl::Context::read_pla
 		CL_EX(clGetPlatformInfo(platform_ids[p], CL_PLATFORM_EXTENSIONS, infostrlen, infostring.get(), nullptr));
 		platform.extensions = infostring.get();
 
-		// enumerate devices
-		cl_uint num_devices;
-		CL_EX(clGetDeviceIDs(platform.id, CL_DEVICE_TYPE_GPU, 0u, nullptr, &num_devices));
-		// if there are no gpu devices on this platform, ignore it entirely
+		// enumerate devices of all types, filtering happens on the snapshot
+		cl_uint num_devices{0u};
+		// CL_DEVICE_NOT_FOUND just means that the platform has no devices
+		cl_int res{clGetDeviceIDs(platform.id, CL_DEVICE_TYPE_ALL, 0u, nullptr, &num_devices)};
+		if(res == CL_DEVICE_NOT_FOUND)
+			num_devices = 0u;
+		else
+			CL_EX(res);
+		// if there are no devices on this platform, ignore it entirely
 		if(num_devices > 0u)
 		{
 			std::unique_ptr<cl_device_id[]> device_ids(new cl_device_id[num_devices]);
-			CL_EX(clGetDeviceIDs(platform.id, CL_DEVICE_TYPE_GPU, num_devices, device_ids.get(), nullptr));
+			CL_EX(clGetDeviceIDs(platform.id, CL_DEVICE_TYPE_ALL, num_devices, device_ids.get(), nullptr));
 
 			// query device info and store suitable ones 
 			for(size_t d = 0; d < num_devices; ++d)
 			{
 				CLDevice device;
-				// device id
-				device.device_id = device_ids[d];
-				// --- check if device is suitable
-				// device version
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_VERSION, 0ull, nullptr, &infostrlen));
-				infostring.reset(new char[infostrlen]);
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_VERSION, infostrlen, infostring.get(), nullptr));
-				device.device_version = infostring.get();
-				// check if device version >= 1.2
-				unsigned int version_identifier{util::get_cl_version_num(device.device_version)};
-				if(version_identifier < 120u)
-					continue;
-				device.device_version_num = version_identifier;
-				// image support
-				cl_bool image_support;
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE_SUPPORT, sizeof(cl_bool), &image_support, nullptr));
-				if(!image_support)
-					continue;
-				// device available
-				cl_bool device_available;
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_AVAILABLE, sizeof(cl_bool), &device_available, nullptr));
-				if(!device_available)
-					continue;
-				// compiler available
-				cl_bool compiler_available;
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_COMPILER_AVAILABLE, sizeof(cl_bool), &compiler_available, nullptr));
-				if(!compiler_available)
-					continue;
-				// linker available
-				cl_bool linker_available;
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_LINKER_AVAILABLE, sizeof(cl_bool), &linker_available, nullptr));
-				if(!linker_available)
-					continue;
-				// exec capabilities
-				cl_device_exec_capabilities exec_capabilities;
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_EXECUTION_CAPABILITIES, sizeof(cl_device_exec_capabilities), &exec_capabilities, nullptr));
-				if(!(exec_capabilities | CL_EXEC_KERNEL))
-					continue;
-
-				// --- additional info
-				// vendor id
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_VENDOR_ID, sizeof(cl_uint), &device.vendor_id, nullptr));
-				// max compute units
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &device.max_compute_units, nullptr));
-				// max work item dimensions
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, sizeof(cl_uint), &device.max_work_item_dimensions, nullptr));
-				// max work item sizes
-				device.max_work_item_sizes = std::vector<std::size_t>(static_cast<std::size_t>(device.max_work_item_dimensions), 0);
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_WORK_ITEM_SIZES, device.max_work_item_sizes.size() * sizeof(std::size_t), device.max_work_item_sizes.data(), nullptr));
-				// max work group size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(std::size_t), &device.max_work_group_size, nullptr));
-				// max mem alloc size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &device.max_mem_alloc_size, nullptr));
-				// image2d max width
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE2D_MAX_WIDTH, sizeof(std::size_t), &device.image2d_max_width, nullptr));
-				// image2d max height
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE2D_MAX_HEIGHT, sizeof(std::size_t), &device.image2d_max_height, nullptr));
-				// image3d max width
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE3D_MAX_WIDTH, sizeof(std::size_t), &device.image3d_max_width, nullptr));
-				// image3d max height
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE3D_MAX_HEIGHT, sizeof(std::size_t), &device.image3d_max_height, nullptr));
-				// image3d max depth
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE3D_MAX_DEPTH, sizeof(std::size_t), &device.image3d_max_depth, nullptr));
-				// image max buffer size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE_MAX_BUFFER_SIZE, sizeof(std::size_t), &device.image_max_buffer_size, nullptr));
-				// image max array size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_IMAGE_MAX_ARRAY_SIZE, sizeof(std::size_t), &device.image_max_array_size, nullptr));
-				// max samplers
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_SAMPLERS, sizeof(cl_uint), &device.max_samplers, nullptr));
-				// max parameter size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_PARAMETER_SIZE, sizeof(std::size_t), &device.max_parameter_size, nullptr));
-				// mem base addr align
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &device.mem_base_addr_align, nullptr));
-				// global mem cacheline size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE, sizeof(cl_uint), &device.global_mem_cacheline_size, nullptr));
-				// global mem cache size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_GLOBAL_MEM_CACHE_SIZE, sizeof(cl_ulong), &device.global_mem_cache_size, nullptr));
-				// global mem size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &device.global_mem_size, nullptr));
-				// max constant buffer size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE, sizeof(cl_ulong), &device.max_constant_buffer_size, nullptr));
-				// max constant args
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_MAX_CONSTANT_ARGS, sizeof(cl_uint), &device.max_constant_args, nullptr));
-				// local mem size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &device.local_mem_size, nullptr));
-				// little or big endian
-				cl_bool little_end;
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_ENDIAN_LITTLE, sizeof(cl_bool), &little_end, nullptr));
-				device.little_endian = (little_end == CL_TRUE);
-				// name
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_NAME, 0ull, nullptr, &infostrlen));
-				infostring.reset(new char[infostrlen]);
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_NAME, infostrlen, infostring.get(), nullptr));
-				device.name = infostring.get();
-				// vendor
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_VENDOR, 0ull, nullptr, &infostrlen));
-				infostring.reset(new char[infostrlen]);
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_VENDOR, infostrlen, infostring.get(), nullptr));
-				device.vendor = infostring.get();
-				// driver version
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DRIVER_VERSION, 0ull, nullptr, &infostrlen));
-				infostring.reset(new char[infostrlen]);
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DRIVER_VERSION, infostrlen, infostring.get(), nullptr));
-				device.driver_version = infostring.get();
-				// device profile
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_PROFILE, 0ull, nullptr, &infostrlen));
-				infostring.reset(new char[infostrlen]);
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_PROFILE, infostrlen, infostring.get(), nullptr));
-				device.device_profile = infostring.get();
-				// device extensions
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_EXTENSIONS, 0ull, nullptr, &infostrlen));
-				infostring.reset(new char[infostrlen]);
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_EXTENSIONS, infostrlen, infostring.get(), nullptr));
-				device.device_extensions = infostring.get();
-				// printf buffer size
-				CL_EX(clGetDeviceInfo(device_ids[d], CL_DEVICE_PRINTF_BUFFER_SIZE, sizeof(std::size_t), &device.printf_buffer_size, nullptr));
+				if(cache_file.empty())
+				{
+					if(!read_device_info(device_ids[d], device))
+						continue;
+				}
+				else
+				{
+					// identifying the device is cheap, the remaining queries are served from the cache if possible
+					const std::string key{platform.name + '\n' + device_info_string(device_ids[d], CL_DEVICE_NAME) + '\n' + device_info_string(device_ids[d], CL_DRIVER_VERSION)};
+					auto it = cached_devices.find(key);
+					if(it == cached_devices.end())
+					{
+						CachedDeviceRecord record;
+						record.suitable = read_device_info(device_ids[d], record.device);
+						it = cached_devices.emplace(key, std::move(record)).first;
+						cache_outdated = true;
+					}
+					if(!it->second.suitable)
+						continue;
+					device = it->second.device;
+					device.device_id = device_ids[d];
+					device.parent_device_id = nullptr;
+				}
 
 				// success! Add the device to the list of suitable devices of the platform.
 				platform.devices.push_back(std::move(device));
@@ -324,10 +700,190 @@ std::vector<simple_cl::cl::Context::CLPlatform> simple_cl::cl::Context::read_pla
 			}
 		}
 	}
+	if(cache_outdated)
+		store_device_info_cache(cache_file, cached_devices);
 	return available_platforms;
 }
 
-void simple_cl::cl::Context::init_cl_instance(std::size_t platform_id, std::size_t device_id)
+bool simple_cl::cl::Context::read_device_info(cl_device_id device_id, CLDevice& device)
+{
+	std::size_t infostrlen{0ull};
+	std::unique_ptr<char[]> infostring;
+	// device id
+	device.device_id = device_id;
+	// --- check if device is suitable
+	// device version
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_VERSION, 0ull, nullptr, &infostrlen));
+	infostring.reset(new char[infostrlen]);
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_VERSION, infostrlen, infostring.get(), nullptr));
+	device.device_version = infostring.get();
+	// check if device version >= 1.2
+	unsigned int version_identifier{util::get_cl_version_num(device.device_version)};
+	if(version_identifier < 120u)
+		return false;
+	device.device_version_num = version_identifier;
+	// image support
+	cl_bool image_support;
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE_SUPPORT, sizeof(cl_bool), &image_support, nullptr));
+	if(!image_support)
+		return false;
+	// device available
+	cl_bool device_available;
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_AVAILABLE, sizeof(cl_bool), &device_available, nullptr));
+	if(!device_available)
+		return false;
+	// compiler available
+	cl_bool compiler_available;
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_COMPILER_AVAILABLE, sizeof(cl_bool), &compiler_available, nullptr));
+	if(!compiler_available)
+		return false;
+	// linker available
+	cl_bool linker_available;
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_LINKER_AVAILABLE, sizeof(cl_bool), &linker_available, nullptr));
+	if(!linker_available)
+		return false;
+	// exec capabilities
+	cl_device_exec_capabilities exec_capabilities;
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_EXECUTION_CAPABILITIES, sizeof(cl_device_exec_capabilities), &exec_capabilities, nullptr));
+	if(!(exec_capabilities | CL_EXEC_KERNEL))
+		return false;
+
+	// --- additional info
+	// device type
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_TYPE, sizeof(cl_device_type), &device.device_type, nullptr));
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_QUEUE_PROPERTIES, sizeof(cl_command_queue_properties), &device.queue_properties, nullptr));
+	// vendor id
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_VENDOR_ID, sizeof(cl_uint), &device.vendor_id, nullptr));
+	// max compute units
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &device.max_compute_units, nullptr));
+	// max work item dimensions
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, sizeof(cl_uint), &device.max_work_item_dimensions, nullptr));
+	// max work item sizes
+	device.max_work_item_sizes = std::vector<std::size_t>(static_cast<std::size_t>(device.max_work_item_dimensions), 0);
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_WORK_ITEM_SIZES, device.max_work_item_sizes.size() * sizeof(std::size_t), device.max_work_item_sizes.data(), nullptr));
+	// max work group size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(std::size_t), &device.max_work_group_size, nullptr));
+	// max mem alloc size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &device.max_mem_alloc_size, nullptr));
+	// image2d max width
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE2D_MAX_WIDTH, sizeof(std::size_t), &device.image2d_max_width, nullptr));
+	// image2d max height
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE2D_MAX_HEIGHT, sizeof(std::size_t), &device.image2d_max_height, nullptr));
+	// image3d max width
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE3D_MAX_WIDTH, sizeof(std::size_t), &device.image3d_max_width, nullptr));
+	// image3d max height
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE3D_MAX_HEIGHT, sizeof(std::size_t), &device.image3d_max_height, nullptr));
+	// image3d max depth
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE3D_MAX_DEPTH, sizeof(std::size_t), &device.image3d_max_depth, nullptr));
+	// image max buffer size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE_MAX_BUFFER_SIZE, sizeof(std::size_t), &device.image_max_buffer_size, nullptr));
+	// image max array size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_IMAGE_MAX_ARRAY_SIZE, sizeof(std::size_t), &device.image_max_array_size, nullptr));
+	// max samplers
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_SAMPLERS, sizeof(cl_uint), &device.max_samplers, nullptr));
+	// max parameter size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_PARAMETER_SIZE, sizeof(std::size_t), &device.max_parameter_size, nullptr));
+	// mem base addr align
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &device.mem_base_addr_align, nullptr));
+	// global mem cacheline size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_GLOBAL_MEM_CACHELINE_SIZE, sizeof(cl_uint), &device.global_mem_cacheline_size, nullptr));
+	// global mem cache size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_GLOBAL_MEM_CACHE_SIZE, sizeof(cl_ulong), &device.global_mem_cache_size, nullptr));
+	// global mem size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &device.global_mem_size, nullptr));
+	// max constant buffer size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE, sizeof(cl_ulong), &device.max_constant_buffer_size, nullptr));
+	// max constant args
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_MAX_CONSTANT_ARGS, sizeof(cl_uint), &device.max_constant_args, nullptr));
+	// local mem size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &device.local_mem_size, nullptr));
+	// little or big endian
+	cl_bool little_end;
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_ENDIAN_LITTLE, sizeof(cl_bool), &little_end, nullptr));
+	device.little_endian = (little_end == CL_TRUE);
+	// name
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_NAME, 0ull, nullptr, &infostrlen));
+	infostring.reset(new char[infostrlen]);
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_NAME, infostrlen, infostring.get(), nullptr));
+	device.name = infostring.get();
+	// vendor
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_VENDOR, 0ull, nullptr, &infostrlen));
+	infostring.reset(new char[infostrlen]);
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_VENDOR, infostrlen, infostring.get(), nullptr));
+	device.vendor = infostring.get();
+	// driver version
+	CL_EX(clGetDeviceInfo(device_id, CL_DRIVER_VERSION, 0ull, nullptr, &infostrlen));
+	infostring.reset(new char[infostrlen]);
+	CL_EX(clGetDeviceInfo(device_id, CL_DRIVER_VERSION, infostrlen, infostring.get(), nullptr));
+	device.driver_version = infostring.get();
+	// device profile
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_PROFILE, 0ull, nullptr, &infostrlen));
+	infostring.reset(new char[infostrlen]);
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_PROFILE, infostrlen, infostring.get(), nullptr));
+	device.device_profile = infostring.get();
+	// device extensions
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_EXTENSIONS, 0ull, nullptr, &infostrlen));
+	infostring.reset(new char[infostrlen]);
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_EXTENSIONS, infostrlen, infostring.get(), nullptr));
+	device.device_extensions = infostring.get();
+	// printf buffer size
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_PRINTF_BUFFER_SIZE, sizeof(std::size_t), &device.printf_buffer_size, nullptr));
+
+	// partitioning
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_PARENT_DEVICE, sizeof(cl_device_id), &device.parent_device_id, nullptr));
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_PARTITION_MAX_SUB_DEVICES, sizeof(cl_uint), &device.partition_max_sub_devices, nullptr));
+	CL_EX(clGetDeviceInfo(device_id, CL_DEVICE_PARTITION_AFFINITY_DOMAIN, sizeof(cl_device_affinity_domain), &device.partition_affinity_domains, nullptr));
+	return true;
+}
+
+std::vector<simple_cl::cl::Context::CLDevice> simple_cl::cl::Context::create_sub_devices(const CLDevice& device, const DevicePartition& partition)
+{
+	if(device.partition_max_sub_devices == 0u)
+		throw std::runtime_error("[Context]: Device cannot be partitioned.");
+	if(partition.scheme == DevicePartition::Scheme::ByAffinityDomain && partition.affinity_domain != DevicePartition::AffinityDomain::NextPartitionable &&
+		!(device.partition_affinity_domains & static_cast<cl_device_affinity_domain>(partition.affinity_domain)))
+		throw std::runtime_error("[Context]: Device cannot be partitioned along the requested affinity domain.");
+
+	// build zero terminated property list
+	std::vector<cl_device_partition_property> properties{static_cast<cl_device_partition_property>(partition.scheme)};
+	switch(partition.scheme)
+	{
+	case DevicePartition::Scheme::Equally:
+		properties.push_back(static_cast<cl_device_partition_property>(partition.compute_units));
+		break;
+	case DevicePartition::Scheme::ByCounts:
+		for(unsigned int count : partition.compute_unit_counts)
+			properties.push_back(static_cast<cl_device_partition_property>(count));
+		properties.push_back(CL_DEVICE_PARTITION_BY_COUNTS_LIST_END);
+		break;
+	case DevicePartition::Scheme::ByAffinityDomain:
+		properties.push_back(static_cast<cl_device_partition_property>(partition.affinity_domain));
+		break;
+	}
+	properties.push_back(cl_device_partition_property{0});
+
+	cl_uint num_sub_devices{0u};
+	CL_EX(clCreateSubDevices(device.device_id, properties.data(), 0u, nullptr, &num_sub_devices));
+	std::vector<cl_device_id> sub_device_ids(num_sub_devices);
+	CL_EX(clCreateSubDevices(device.device_id, properties.data(), num_sub_devices, sub_device_ids.data(), nullptr));
+
+	std::vector<CLDevice> sub_devices(sub_device_ids.size());
+	try
+	{
+		for(std::size_t s = 0ull; s < sub_device_ids.size(); ++s)
+			if(!read_device_info(sub_device_ids[s], sub_devices[s]))
+				throw std::runtime_error("[Context]: Sub-device is not suitable.");
+	}
+	catch(...)
+	{
+		for(cl_device_id sub_device_id : sub_device_ids)
+			CL(clReleaseDevice(sub_device_id));
+		throw;
+	}
+	return sub_devices;
+}
+
+void simple_cl::cl::Context::init_cl_instance(std::size_t platform_id, const std::vector<std::size_t>& device_ids, QueueProperties queue_properties, bool verbose)
 {
 	if(m_available_platforms.size() == 0ull)
 		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: No suitable OpenCL 1.2 platform found.");
@@ -335,29 +891,48 @@ void simple_cl::cl::Context::init_cl_instance(std::size_t platform_id, std::size
 		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Platform index out of range.");
 	if(m_available_platforms[platform_id].devices.size() == 0ull)
 		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: No suitable OpenCL 1.2 device found.");
-	if(device_id >= m_available_platforms[platform_id].devices.size())
-		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Device index out of range.");
+	if(device_ids.size() == 0ull)
+		throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: No device selected.");
+	for(std::size_t i = 0ull; i < device_ids.size(); ++i)
+	{
+		if(device_ids[i] >= m_available_platforms[platform_id].devices.size())
+			throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Device index out of range.");
+		for(std::size_t j = 0ull; j < i; ++j)
+			if(device_ids[i] == device_ids[j])
+				throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Device selected more than once.");
+	}
 
-	// select device and platform
-	// TODO: Future me: maybe use all available devices of one platform? Would be nice to have the option...
+	// select platform and devices
 	m_selected_platform_index = platform_id;
-	m_selected_device_index = device_id;
+	m_selected_devices.clear();
+	for(std::size_t device_id : device_ids)
+		m_selected_devices.push_back(m_available_platforms[platform_id].devices[device_id]);
 
-	std::cout << std::endl << "========== OPENCL INITIALIZATION ==========" << std::endl;
-	std::cout << "Selected platform ID: " << m_selected_platform_index << std::endl;
-	std::cout << "Selected device ID: " << m_selected_device_index << std::endl << std::endl;
+	if(verbose)
+	{
+		std::cout << std::endl << "========== OPENCL INITIALIZATION ==========" << std::endl;
+		std::cout << "Selected platform ID: " << m_selected_platform_index << std::endl;
+		std::cout << "Selected device ID's:";
+		for(std::size_t device_id : device_ids)
+			std::cout << " " << device_id;
+		std::cout << std::endl << std::endl;
+	}
 
 	// create OpenCL context
-	std::cout << "Creating OpenCL context...";
+	if(verbose)
+		std::cout << "Creating OpenCL context...";
 	cl_context_properties ctprops[]{
 		CL_CONTEXT_PLATFORM,
 		reinterpret_cast<cl_context_properties>(m_available_platforms[m_selected_platform_index].id),
 		0
 	};
+	std::vector<cl_device_id> cl_device_ids;
+	for(const CLDevice& device : m_selected_devices)
+		cl_device_ids.push_back(device.device_id);
 	cl_int res;
 	m_context = clCreateContext(&ctprops[0],
-		1u,
-		&m_available_platforms[m_selected_platform_index].devices[m_selected_device_index].device_id,
+		static_cast<cl_uint>(cl_device_ids.size()),
+		cl_device_ids.data(),
 		&create_context_callback,
 		&m_cl_ex_holder,
 		&res
@@ -365,39 +940,121 @@ void simple_cl::cl::Context::init_cl_instance(std::size_t platform_id, std::size
 	// if an error occured during context creation, throw an appropriate exception.
 	if(res != CL_SUCCESS)
 		throw CLException(res, __LINE__, __FILE__, m_cl_ex_holder.ex_msg);
-	std::cout << " done!" << std::endl;
-
-	// create command queue
-	std::cout << "Creating command queue...";
-	m_command_queue = clCreateCommandQueue(m_context,
-		m_available_platforms[m_selected_platform_index].devices[m_selected_device_index].device_id,
-		cl_command_queue_properties{0ull},
-		&res
-	);
-	if(res != CL_SUCCESS)
-		throw CLException(res, __LINE__, __FILE__, "Command queue creation failed.");
-	std::cout << " done!" << std::endl;
+	if(verbose)
+		std::cout << " done!" << std::endl;
+
+	// create one command queue per device
+	if(verbose)
+		std::cout << "Creating command queues...";
+	const cl_command_queue_properties props{static_cast<cl_command_queue_properties>(queue_properties)};
+	for(const CLDevice& device : m_selected_devices)
+		if((props & ~device.queue_properties) != cl_command_queue_properties{0ull})
+			throw std::runtime_error("[OCL_TEMPLATE_MATCHER]: Requested command queue properties are not supported by the device.");
+	for(cl_device_id device_id : cl_device_ids)
+	{
+		cl_command_queue queue = clCreateCommandQueue(m_context,
+			device_id,
+			props,
+			&res
+		);
+		if(res != CL_SUCCESS)
+			throw CLException(res, __LINE__, __FILE__, "Command queue creation failed.");
+		m_command_queues.push_back(queue);
+	}
+	if(verbose)
+		std::cout << " done!" << std::endl;
 }
 
 void simple_cl::cl::Context::cleanup()
 {
-	if(m_command_queue)
-		CL(clReleaseCommandQueue(m_command_queue));
-	m_command_queue = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_additional_queues_mutex);
+		for(cl_command_queue queue : m_additional_queues)
+			CL(clReleaseCommandQueue(queue));
+		m_additional_queues.clear();
+	}
+	for(cl_command_queue queue : m_command_queues)
+		CL(clReleaseCommandQueue(queue));
+	m_command_queues.clear();
 	if(m_context)
 		CL(clReleaseContext(m_context));
 	m_context = nullptr;
+	// sub-devices are owned by the context they were selected for
+	for(const CLDevice& device : m_selected_devices)
+		if(device.parent_device_id)
+			CL(clReleaseDevice(device.device_id));
+	m_selected_devices.clear();
 	m_cl_ex_holder.ex_msg = nullptr;
 }
 
+simple_cl::cl::Queue simple_cl::cl::Context::create_queue(std::size_t device_index, QueueProperties properties)
+{
+	const CLDevice& device = get_selected_device(device_index);
+	const cl_command_queue_properties props = static_cast<cl_command_queue_properties>(properties);
+	if((props & ~device.queue_properties) != cl_command_queue_properties{0ull})
+		throw std::runtime_error("[Context]: Requested command queue properties are not supported by the device.");
+
+	cl_int err;
+	cl_command_queue queue = clCreateCommandQueue(m_context, device.device_id, props, &err);
+	CL_EX(err);
+	try
+	{
+		std::lock_guard<std::mutex> lock(m_additional_queues_mutex);
+		m_additional_queues.push_back(queue);
+	}
+	catch(...)
+	{
+		CL(clReleaseCommandQueue(queue));
+		throw;
+	}
+	return Queue{device_index, queue};
+}
+
+void simple_cl::cl::Context::flush(const Queue& queue) const
+{
+	CL_EX(clFlush(command_queue(queue)));
+}
+
+void simple_cl::cl::Context::finish(const Queue& queue) const
+{
+	CL_EX(clFinish(command_queue(queue)));
+}
+
+simple_cl::cl::Event simple_cl::cl::Context::enqueue_marker(const Queue& queue) const
+{
+	return enqueue_marker_(EventList{}, queue);
+}
+
+simple_cl::cl::Event simple_cl::cl::Context::enqueue_barrier(const Queue& queue) const
+{
+	return enqueue_barrier_(EventList{}, queue);
+}
+
+simple_cl::cl::Event simple_cl::cl::Context::enqueue_marker_(const EventList& dep_events, const Queue& queue) const
+{
+	// a marker without event is pointless, so it is created regardless of queue.events_enabled()
+	cl_event ev{nullptr};
+	CL_EX(clEnqueueMarkerWithWaitList(command_queue(queue), static_cast<cl_uint>(dep_events.size()), dep_events.data(), &ev));
+	return Event{ev};
+}
+
+simple_cl::cl::Event simple_cl::cl::Context::enqueue_barrier_(const EventList& dep_events, const Queue& queue) const
+{
+	cl_event ev{nullptr};
+	CL_EX(clEnqueueBarrierWithWaitList(command_queue(queue), static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &ev : nullptr));
+	return Event{ev};
+}
+
 const simple_cl::cl::Context::CLPlatform& simple_cl::cl::Context::get_selected_platform() const
 {
 	return m_available_platforms[m_selected_platform_index];
 }
 
-const simple_cl::cl::Context::CLDevice& simple_cl::cl::Context::get_selected_device() const
+const simple_cl::cl::Context::CLDevice& simple_cl::cl::Context::get_selected_device(std::size_t device_index) const
 {
-	return m_available_platforms[m_selected_platform_index].devices[m_selected_device_index];
+	if(device_index >= m_selected_devices.size())
+		throw std::out_of_range("[Context]: Device index out of range.");
+	return m_selected_devices[device_index];
 }
 
 std::ostream& simple_cl::cl::operator<<(std::ostream& os, const simple_cl::cl::Context::CLPlatform& plat)
@@ -420,6 +1077,8 @@ std::ostream& simple_cl::cl::operator<<(std::ostream& os, const simple_cl::cl::C
 std::ostream& simple_cl::cl::operator<<(std::ostream& os, const simple_cl::cl::Context::CLDevice& dev)
 {
 	os << "===== OpenCL Device =====" << std::endl
+		<< "Device type:" << std::endl
+		<< "\t" << device_type_string(dev.device_type) << std::endl
 		<< "Vendor ID:" << std::endl
 		<< "\t" << dev.vendor_id << std::endl
 		<< "Name:" << std::endl
@@ -464,7 +1123,7 @@ std::ostream& simple_cl::cl::operator<<(std::ostream& os, const simple_cl::cl::C
 		<< "Max. parameter size:" << std::endl
 		<< "\t" << dev.max_parameter_size << " bytes" << std::endl
 		<< "Memory base address alignment:" << std::endl
-		<< "\t" << dev.mem_base_addr_align << " bytes" << std::endl
+		<< "\t" << dev.mem_base_addr_align << " bits" << std::endl
 		<< "Global memory cache line size:" << std::endl
 		<< "\t" << dev.global_mem_cacheline_size << " bytes" << std::endl
 		<< "Global memory cache size:" << std::endl
@@ -479,6 +1138,12 @@ std::ostream& simple_cl::cl::operator<<(std::ostream& os, const simple_cl::cl::C
 		<< "\t" << dev.local_mem_size << " bytes" << std::endl
 		<< "Little endian:" << std::endl
 		<< "\t" << (dev.little_endian ? "yes" : "no") << std::endl
+		<< "Sub-device:" << std::endl
+		<< "\t" << (dev.parent_device_id ? "yes" : "no") << std::endl
+		<< "Max. sub-devices:" << std::endl
+		<< "\t" << dev.partition_max_sub_devices << std::endl
+		<< "Out-of-order queues:" << std::endl
+		<< "\t" << ((dev.queue_properties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) ? "yes" : "no") << std::endl
 		<< "printf buffer size:" << std::endl
 		<< "\t" << dev.printf_buffer_size << " bytes" << std::endl
 		<< "Extensions:" << std::endl
@@ -495,76 +1160,409 @@ void simple_cl::cl::create_context_callback(const char* errinfo, const void* pri
 
 #pragma endregion
 
-#pragma region class Program
-// -------------------------- class Program
+#pragma region class ProgramModule
+// -------------------------- class ProgramModule
 
-simple_cl::cl::Program::Program(const std::string& kernel_source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate) :
-	m_source(kernel_source),
-	m_kernels(),
-	m_cl_state(clstate),
-	m_cl_program(nullptr),
-	m_options(compiler_options),
-	m_event_cache()
+namespace
 {
-	try
+	// Process-wide program binary cache settings, see Program::setBinaryCacheDirectory().
+	struct BinaryCacheSettings
 	{
-		// create program
-		const char* source = m_source.data();
-		std::size_t source_len = m_source.size();
-		cl_int res;
-		m_cl_program = clCreateProgramWithSource(m_cl_state->context(), 1u, &source, &source_len, &res);
-		if(res != CL_SUCCESS)
-			throw CLException{res, __LINE__, __FILE__, "clCreateProgramWithSource failed."};
-		
-		// build program // TODO: Multiple devices?
-		res = clBuildProgram(m_cl_program, 1u, &m_cl_state->get_selected_device().device_id, m_options.data(), nullptr, nullptr);
-		if(res != CL_SUCCESS)
-		{
-			if(res == CL_BUILD_PROGRAM_FAILURE)
-			{
-				std::size_t log_size{0};
-				CL_EX(clGetProgramBuildInfo(m_cl_program, m_cl_state->get_selected_device().device_id, CL_PROGRAM_BUILD_LOG, 0ull, nullptr, &log_size));
-				std::unique_ptr<char[]> infostring{new char[log_size]};
-				CL_EX(clGetProgramBuildInfo(m_cl_program, m_cl_state->get_selected_device().device_id, CL_PROGRAM_BUILD_LOG, log_size, infostring.get(), nullptr));
-				std::cerr << "OpenCL program build failed:" << std::endl << infostring.get() << std::endl;
-				throw CLException{res, __LINE__, __FILE__, "OpenCL program build failed."};
-			}
-			else
-			{
-				throw CLException{res, __LINE__, __FILE__, "clBuildProgram failed."};
-			}
-		}
+		std::mutex mutex;
+		std::string directory;
+	};
 
-		// extract kernels and parameters
-		std::size_t num_kernels{0};
-		CL_EX(clGetProgramInfo(m_cl_program, CL_PROGRAM_NUM_KERNELS, sizeof(std::size_t), &num_kernels, nullptr));
-		std::size_t kernel_name_string_length{0};
-		CL_EX(clGetProgramInfo(m_cl_program, CL_PROGRAM_KERNEL_NAMES, 0ull, nullptr, &kernel_name_string_length));
-		std::unique_ptr<char[]> kernel_name_string{new char[kernel_name_string_length]};
-		CL_EX(clGetProgramInfo(m_cl_program, CL_PROGRAM_KERNEL_NAMES, kernel_name_string_length, kernel_name_string.get(), nullptr));
-		std::vector<std::string> kernel_names{util::string_split(std::string{kernel_name_string.get()}, ';')};
-		if(kernel_names.size() != num_kernels)
-			throw std::logic_error("Number of kernels in program does not match reported number of kernels.");
-
-		// create kernels
-		for(std::size_t i = 0; i < num_kernels; ++i)
-		{
-			cl_kernel kernel = clCreateKernel(m_cl_program, kernel_names[i].c_str(), &res); if(res != CL_SUCCESS) throw CLException{res, __LINE__, __FILE__, "clCreateKernel failed."};			
-			m_kernels[kernel_names[i]] = CLKernel{i, {}, kernel};
-			// query per-kernel info
-			CLKernelInfo kinfo;
-			std::size_t sz{0ull};
-			cl_ulong usz{0ul};
-			CL_EX(clGetKernelWorkGroupInfo(kernel, m_cl_state->get_selected_device().device_id, CL_KERNEL_WORK_GROUP_SIZE, sizeof(std::size_t), &sz, nullptr));
-			kinfo.max_work_group_size = sz; sz = 0ull;
-			CL_EX(clGetKernelWorkGroupInfo(kernel, m_cl_state->get_selected_device().device_id, CL_KERNEL_LOCAL_MEM_SIZE, sizeof(cl_ulong), &usz, nullptr));
-			kinfo.local_memory_usage = std::size_t{usz}; usz = 0ul;
-			CL_EX(clGetKernelWorkGroupInfo(kernel, m_cl_state->get_selected_device().device_id, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(std::size_t), &sz, nullptr));
-			kinfo.preferred_work_group_size_multiple = sz; sz = 0ull;
-			CL_EX(clGetKernelWorkGroupInfo(kernel, m_cl_state->get_selected_device().device_id, CL_KERNEL_PRIVATE_MEM_SIZE, sizeof(cl_ulong), &usz, nullptr));
-			kinfo.private_memory_usage = std::size_t{usz};
-			m_kernels[kernel_names[i]].kernel_info = kinfo;
+	BinaryCacheSettings& binary_cache_settings()
+	{
+		static BinaryCacheSettings settings;
+		return settings;
+	}
+
+	std::string binary_cache_directory()
+	{
+		BinaryCacheSettings& settings = binary_cache_settings();
+		std::lock_guard<std::mutex> lock(settings.mutex);
+		return settings.directory;
+	}
+
+	// Returns a process-wide unique program id. Ids are never reused.
+	std::uint64_t next_program_uid()
+	{
+		static std::atomic<std::uint64_t> next_uid{0ull};
+		return next_uid.fetch_add(1ull, std::memory_order_relaxed);
+	}
+
+	// Returns the cache file path of a binary. key_hash identifies the source (and options), the device is mixed in here.
+	std::string binary_cache_path(const std::string& directory, std::uint64_t key_hash, const simple_cl::cl::Context& context, const simple_cl::cl::Context::CLDevice& device, const char* extension)
+	{
+		// strings are hashed including their terminating zero to separate them
+		const std::string& platform_name = context.get_selected_platform().name;
+		std::uint64_t hash{simple_cl::util::fnv1a_64(platform_name.c_str(), platform_name.size() + 1ull, key_hash)};
+		hash = simple_cl::util::fnv1a_64(device.name.c_str(), device.name.size() + 1ull, hash);
+		hash = simple_cl::util::fnv1a_64(device.driver_version.c_str(), device.driver_version.size() + 1ull, hash);
+
+		std::ostringstream path;
+		path << directory;
+		if(!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+			path << '/';
+		path << std::hex << std::setw(16) << std::setfill('0') << hash << extension;
+		return path.str();
+	}
+
+	// Reads cached binaries. Cache file layout: FNV-1a hash of the binary followed by the binary itself. Returns false if any file is missing or corrupt.
+	bool load_cached_binaries(const std::vector<std::string>& paths, std::vector<std::vector<unsigned char>>& binaries)
+	{
+		binaries.clear();
+		for(const std::string& path : paths)
+		{
+			std::ifstream file(path, std::ios::binary);
+			std::uint64_t stored_hash{0ull};
+			if(!file.read(reinterpret_cast<char*>(&stored_hash), sizeof(stored_hash)))
+				return false;
+			std::vector<unsigned char> binary{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+			if(binary.empty() || simple_cl::util::fnv1a_64(binary.data(), binary.size()) != stored_hash)
+				return false;
+			binaries.push_back(std::move(binary));
+		}
+		return true;
+	}
+
+	// Creates a program from one binary per device. Returns nullptr if the runtime rejects any of them or if they are not of the expected binary type.
+	cl_program create_program_with_binaries(cl_context context, const std::vector<cl_device_id>& device_ids, const std::vector<std::vector<unsigned char>>& binaries, cl_program_binary_type expected_type)
+	{
+		std::vector<std::size_t> lengths;
+		std::vector<const unsigned char*> binary_ptrs;
+		for(const std::vector<unsigned char>& binary : binaries)
+		{
+			lengths.push_back(binary.size());
+			binary_ptrs.push_back(binary.data());
+		}
+		std::vector<cl_int> binary_status(binaries.size(), CL_SUCCESS);
+		cl_int res;
+		cl_program program = clCreateProgramWithBinary(context, static_cast<cl_uint>(device_ids.size()), device_ids.data(), lengths.data(), binary_ptrs.data(), binary_status.data(), &res);
+		bool success{res == CL_SUCCESS};
+		for(cl_int status : binary_status)
+			success = success && status == CL_SUCCESS;
+		for(std::size_t d = 0ull; success && d < device_ids.size(); ++d)
+		{
+			cl_program_binary_type binary_type{CL_PROGRAM_BINARY_TYPE_NONE};
+			success = clGetProgramBuildInfo(program, device_ids[d], CL_PROGRAM_BINARY_TYPE, sizeof(cl_program_binary_type), &binary_type, nullptr) == CL_SUCCESS && binary_type == expected_type;
+		}
+		if(!success && program)
+		{
+			CL(clReleaseProgram(program));
+			program = nullptr;
+		}
+		return program;
+	}
+
+	// Stores the binaries of a program for the given devices at the given paths (same order). Failures are ignored, the cache is an optimization only.
+	void store_cached_binaries(cl_program program, const std::vector<cl_device_id>& device_ids, const std::vector<std::string>& paths)
+	{
+		try
+		{
+			// binaries are reported in the order of CL_PROGRAM_DEVICES
+			cl_uint num_devices{0u};
+			CL_EX(clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &num_devices, nullptr));
+			std::vector<cl_device_id> program_devices(num_devices);
+			CL_EX(clGetProgramInfo(program, CL_PROGRAM_DEVICES, num_devices * sizeof(cl_device_id), program_devices.data(), nullptr));
+			std::vector<std::size_t> sizes(num_devices);
+			CL_EX(clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, num_devices * sizeof(std::size_t), sizes.data(), nullptr));
+			std::vector<std::vector<unsigned char>> binaries(num_devices);
+			std::vector<unsigned char*> binary_ptrs(num_devices);
+			for(cl_uint d = 0u; d < num_devices; ++d)
+			{
+				binaries[d].resize(sizes[d]);
+				binary_ptrs[d] = binaries[d].data();
+			}
+			CL_EX(clGetProgramInfo(program, CL_PROGRAM_BINARIES, num_devices * sizeof(unsigned char*), binary_ptrs.data(), nullptr));
+
+			for(std::size_t i = 0ull; i < device_ids.size() && i < paths.size(); ++i)
+			{
+				std::size_t d = static_cast<std::size_t>(std::find(program_devices.begin(), program_devices.end(), device_ids[i]) - program_devices.begin());
+				if(d >= binaries.size() || binaries[d].empty())
+					continue;
+				// write to a temporary file first so that concurrent readers never see partial binaries
+				const std::string temp_path{paths[i] + ".tmp" + simple_cl::util::unique_temp_suffix()};
+				{
+					std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+					const std::uint64_t hash{simple_cl::util::fnv1a_64(binaries[d].data(), binaries[d].size())};
+					file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+					file.write(reinterpret_cast<const char*>(binaries[d].data()), static_cast<std::streamsize>(binaries[d].size()));
+					if(!file)
+					{
+						file.close();
+						std::remove(temp_path.c_str());
+						continue;
+					}
+				}
+				if(std::rename(temp_path.c_str(), paths[i].c_str()) != 0)
+					std::remove(temp_path.c_str());
+			}
 		}
+		catch(...)
+		{
+		}
+	}
+
+	// Prints the build (or compile / link) logs of a program for all devices.
+	void print_build_logs(cl_program program, const std::vector<cl_device_id>& device_ids, const char* what)
+	{
+		for(cl_device_id device_id : device_ids)
+		{
+			std::size_t log_size{0};
+			CL_EX(clGetProgramBuildInfo(program, device_id, CL_PROGRAM_BUILD_LOG, 0ull, nullptr, &log_size));
+			std::unique_ptr<char[]> infostring{new char[log_size]};
+			CL_EX(clGetProgramBuildInfo(program, device_id, CL_PROGRAM_BUILD_LOG, log_size, infostring.get(), nullptr));
+			std::cerr << what << std::endl << infostring.get() << std::endl;
+		}
+	}
+
+	std::vector<cl_device_id> context_device_ids(const simple_cl::cl::Context& context)
+	{
+		std::vector<cl_device_id> device_ids;
+		for(const simple_cl::cl::Context::CLDevice& device : context.get_selected_devices())
+			device_ids.push_back(device.device_id);
+		return device_ids;
+	}
+}
+
+simple_cl::cl::ProgramModule::ProgramModule(const std::string& source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate, const std::vector<Header>& headers) :
+	m_source(source),
+	m_options(compiler_options),
+	m_headers(headers),
+	m_cl_state(clstate),
+	m_cl_program(nullptr)
+{
+	try
+	{
+		const std::vector<cl_device_id> device_ids{context_device_ids(*m_cl_state)};
+		const std::string cache_directory{binary_cache_directory()};
+		std::vector<std::string> paths;
+		for(const Context::CLDevice& device : m_cl_state->get_selected_devices())
+			paths.push_back(binaryCachePath(cache_directory, device));
+
+		std::vector<std::vector<unsigned char>> binaries;
+		if(!cache_directory.empty() && load_cached_binaries(paths, binaries))
+			m_cl_program = create_program_with_binaries(m_cl_state->context(), device_ids, binaries, CL_PROGRAM_BINARY_TYPE_COMPILED_OBJECT);
+		if(!m_cl_program)
+		{
+			compileFromSource(device_ids);
+			if(!cache_directory.empty())
+				store_cached_binaries(m_cl_program, device_ids, paths);
+		}
+	}
+	catch(...)
+	{
+		cleanup();
+		throw;
+	}
+}
+
+simple_cl::cl::ProgramModule::~ProgramModule()
+{
+	cleanup();
+}
+
+simple_cl::cl::ProgramModule::ProgramModule(ProgramModule&& other) noexcept :
+	m_source{std::move(other.m_source)},
+	m_options{std::move(other.m_options)},
+	m_headers{std::move(other.m_headers)},
+	m_cl_state{std::move(other.m_cl_state)},
+	m_cl_program{other.m_cl_program}
+{
+	other.m_cl_program = nullptr;
+}
+
+simple_cl::cl::ProgramModule& simple_cl::cl::ProgramModule::operator=(ProgramModule&& other) noexcept
+{
+	if(this == &other)
+		return *this;
+
+	cleanup();
+	m_source = std::move(other.m_source);
+	m_options = std::move(other.m_options);
+	m_headers = std::move(other.m_headers);
+	m_cl_state = std::move(other.m_cl_state);
+	std::swap(m_cl_program, other.m_cl_program);
+
+	return *this;
+}
+
+void simple_cl::cl::ProgramModule::cleanup() noexcept
+{
+	if(m_cl_program)
+		clReleaseProgram(m_cl_program);
+	m_cl_program = nullptr;
+}
+
+void simple_cl::cl::ProgramModule::compileFromSource(const std::vector<cl_device_id>& device_ids)
+{
+	cl_int res;
+	// embedded headers become programs of their own which are referenced by their include names
+	std::vector<cl_program> header_programs;
+	std::vector<const char*> header_names;
+	try
+	{
+		for(const Header& header : m_headers)
+		{
+			const char* header_source = header.source.data();
+			std::size_t header_source_len = header.source.size();
+			header_programs.push_back(clCreateProgramWithSource(m_cl_state->context(), 1u, &header_source, &header_source_len, &res));
+			if(res != CL_SUCCESS)
+			{
+				header_programs.pop_back();
+				throw CLException{res, __LINE__, __FILE__, "clCreateProgramWithSource failed."};
+			}
+			header_names.push_back(header.name.c_str());
+		}
+
+		const char* source = m_source.data();
+		std::size_t source_len = m_source.size();
+		m_cl_program = clCreateProgramWithSource(m_cl_state->context(), 1u, &source, &source_len, &res);
+		if(res != CL_SUCCESS)
+			throw CLException{res, __LINE__, __FILE__, "clCreateProgramWithSource failed."};
+
+		res = clCompileProgram(m_cl_program, static_cast<cl_uint>(device_ids.size()), device_ids.data(), m_options.c_str(),
+			static_cast<cl_uint>(header_programs.size()), header_programs.empty() ? nullptr : header_programs.data(), header_names.empty() ? nullptr : header_names.data(), nullptr, nullptr);
+		if(res == CL_COMPILE_PROGRAM_FAILURE)
+			print_build_logs(m_cl_program, device_ids, "OpenCL program compilation failed:");
+		if(res != CL_SUCCESS)
+			throw CLException{res, __LINE__, __FILE__, "clCompileProgram failed."};
+	}
+	catch(...)
+	{
+		for(cl_program header_program : header_programs)
+			CL(clReleaseProgram(header_program));
+		throw;
+	}
+	for(cl_program header_program : header_programs)
+		CL(clReleaseProgram(header_program));
+}
+
+std::string simple_cl::cl::ProgramModule::binaryCachePath(const std::string& directory, const Context::CLDevice& device) const
+{
+	std::uint64_t hash{util::fnv1a_64(m_source.c_str(), m_source.size() + 1ull)};
+	hash = util::fnv1a_64(m_options.c_str(), m_options.size() + 1ull, hash);
+	for(const Header& header : m_headers)
+	{
+		hash = util::fnv1a_64(header.name.c_str(), header.name.size() + 1ull, hash);
+		hash = util::fnv1a_64(header.source.c_str(), header.source.size() + 1ull, hash);
+	}
+	return binary_cache_path(directory, hash, *m_cl_state, device, ".clobj");
+}
+
+#pragma endregion
+
+#pragma region class Program
+// -------------------------- class Program
+
+simple_cl::cl::Program::Program(const std::string& kernel_source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate) :
+	m_source(kernel_source),
+	m_kernels(),
+	m_cl_state(clstate),
+	m_cl_program(nullptr),
+	m_options(compiler_options),
+	m_uid(next_program_uid()),
+	m_concurrent_invocation(false),
+	m_invoke_state(new InvokeState),
+	m_thread_invoke_states(std::make_shared<ThreadInvokeStates>())
+{
+	try
+	{
+		const std::vector<cl_device_id> device_ids{context_device_ids(*m_cl_state)};
+		const std::string cache_directory{binary_cache_directory()};
+		if(cache_directory.empty() || !loadCachedBinaries(device_ids, cache_directory))
+		{
+			buildFromSource(device_ids);
+			if(!cache_directory.empty())
+				storeCachedBinaries(cache_directory);
+		}
+		createKernels(device_ids);
+	}
+	catch(...)
+	{
+		cleanup();
+		throw;
+	}
+}
+
+void simple_cl::cl::Program::buildFromSource(const std::vector<cl_device_id>& device_ids)
+{
+	// create program
+	const char* source = m_source.data();
+	std::size_t source_len = m_source.size();
+	cl_int res;
+	m_cl_program = clCreateProgramWithSource(m_cl_state->context(), 1u, &source, &source_len, &res);
+	if(res != CL_SUCCESS)
+		throw CLException{res, __LINE__, __FILE__, "clCreateProgramWithSource failed."};
+	
+	// build program for all devices of the context
+	res = clBuildProgram(m_cl_program, static_cast<cl_uint>(device_ids.size()), device_ids.data(), m_options.data(), nullptr, nullptr);
+	if(res != CL_SUCCESS)
+	{
+		if(res == CL_BUILD_PROGRAM_FAILURE)
+		{
+			print_build_logs(m_cl_program, device_ids, "OpenCL program build failed:");
+			throw CLException{res, __LINE__, __FILE__, "OpenCL program build failed."};
+		}
+		else
+		{
+			throw CLException{res, __LINE__, __FILE__, "clBuildProgram failed."};
+		}
+	}
+}
+
+std::string simple_cl::cl::Program::binaryCachePath(const std::string& directory, const Context::CLDevice& device) const
+{
+	std::uint64_t hash{util::fnv1a_64(m_source.c_str(), m_source.size() + 1ull)};
+	hash = util::fnv1a_64(m_options.c_str(), m_options.size() + 1ull, hash);
+	return binary_cache_path(directory, hash, *m_cl_state, device, ".clbin");
+}
+
+bool simple_cl::cl::Program::loadCachedBinaries(const std::vector<cl_device_id>& device_ids, const std::string& directory)
+{
+	std::vector<std::string> paths;
+	for(const Context::CLDevice& device : m_cl_state->get_selected_devices())
+		paths.push_back(binaryCachePath(directory, device));
+	std::vector<std::vector<unsigned char>> binaries;
+	if(!load_cached_binaries(paths, binaries))
+		return false;
+	m_cl_program = create_program_with_binaries(m_cl_state->context(), device_ids, binaries, CL_PROGRAM_BINARY_TYPE_EXECUTABLE);
+	if(!m_cl_program)
+		return false;
+	// binaries still have to be built, this is cheap compared to compiling the source
+	if(clBuildProgram(m_cl_program, static_cast<cl_uint>(device_ids.size()), device_ids.data(), m_options.data(), nullptr, nullptr) != CL_SUCCESS)
+	{
+		CL(clReleaseProgram(m_cl_program));
+		m_cl_program = nullptr;
+		return false;
+	}
+	return true;
+}
+
+void simple_cl::cl::Program::storeCachedBinaries(const std::string& directory) const
+{
+	std::vector<std::string> paths;
+	for(const Context::CLDevice& device : m_cl_state->get_selected_devices())
+		paths.push_back(binaryCachePath(directory, device));
+	store_cached_binaries(m_cl_program, context_device_ids(*m_cl_state), paths);
+}
+
+simple_cl::cl::Program::Program(cl_program linked_program, const std::string& linker_options, const std::shared_ptr<Context>& clstate) :
+	m_source(),
+	m_options(linker_options),
+	m_kernels(),
+	m_cl_program(linked_program),
+	m_cl_state(clstate),
+	m_uid(next_program_uid()),
+	m_concurrent_invocation(false),
+	m_invoke_state(new InvokeState),
+	m_thread_invoke_states(std::make_shared<ThreadInvokeStates>())
+{
+	try
+	{
+		createKernels(context_device_ids(*m_cl_state));
 	}
 	catch(...)
 	{
@@ -573,6 +1571,189 @@ simple_cl::cl::Program::Program(const std::string& kernel_source, const std::str
 	}
 }
 
+simple_cl::cl::Program simple_cl::cl::Program::link(const std::vector<const ProgramModule*>& modules, const std::string& linker_options, const std::shared_ptr<Context>& clstate)
+{
+	std::vector<cl_program> input_programs;
+	for(const ProgramModule* module : modules)
+	{
+		if(!module || !module->m_cl_program)
+			throw std::runtime_error("[Program]: Invalid program module.");
+		if(module->m_cl_state != clstate)
+			throw std::runtime_error("[Program]: Program modules must belong to the linking Context.");
+		input_programs.push_back(module->m_cl_program);
+	}
+	const std::vector<cl_device_id> device_ids{context_device_ids(*clstate)};
+	cl_int res;
+	cl_program linked_program = clLinkProgram(clstate->context(), static_cast<cl_uint>(device_ids.size()), device_ids.data(), linker_options.c_str(),
+		static_cast<cl_uint>(input_programs.size()), input_programs.data(), nullptr, nullptr, &res);
+	if(res != CL_SUCCESS)
+	{
+		// on link failures a valid program object is returned which holds the link log
+		if(linked_program)
+		{
+			if(res == CL_LINK_PROGRAM_FAILURE)
+				print_build_logs(linked_program, device_ids, "OpenCL program link failed:");
+			CL(clReleaseProgram(linked_program));
+		}
+		throw CLException{res, __LINE__, __FILE__, "clLinkProgram failed."};
+	}
+	return Program{linked_program, linker_options, clstate};
+}
+
+std::shared_ptr<simple_cl::cl::Program> simple_cl::cl::Program::getShared(const std::string& source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate)
+{
+	std::ostringstream key_stream;
+	key_stream << std::hex << std::setw(16) << std::setfill('0') << util::fnv1a_64(source.data(), source.size()) << '\n' << compiler_options;
+	const std::string key{key_stream.str()};
+
+	// returns the live program of the entry if it was built from the same source (guards against hash collisions)
+	auto live_program = [&source](const Context::ProgramRegistryEntry& entry) {
+		std::shared_ptr<Program> program{entry.program.lock()};
+		return (program && program->m_source == source) ? program : std::shared_ptr<Program>{};
+	};
+
+	std::shared_ptr<std::mutex> build_mutex;
+	{
+		std::lock_guard<std::mutex> lock(clstate->m_program_registry_mutex);
+		Context::ProgramRegistryEntry& entry = clstate->m_program_registry[key];
+		if(std::shared_ptr<Program> program = live_program(entry))
+			return program;
+		if(!entry.build_mutex)
+			entry.build_mutex = std::make_shared<std::mutex>();
+		build_mutex = entry.build_mutex;
+	}
+
+	std::lock_guard<std::mutex> build_lock(*build_mutex);
+	{
+		// another thread might have built the program while we were waiting
+		std::lock_guard<std::mutex> lock(clstate->m_program_registry_mutex);
+		if(std::shared_ptr<Program> program = live_program(clstate->m_program_registry[key]))
+			return program;
+	}
+	std::shared_ptr<Program> program{std::make_shared<Program>(source, compiler_options, clstate)};
+	{
+		std::lock_guard<std::mutex> lock(clstate->m_program_registry_mutex);
+		// drop entries of programs which died and are not being built
+		for(auto it = clstate->m_program_registry.begin(); it != clstate->m_program_registry.end();)
+		{
+			if(it->first != key && it->second.program.expired() && it->second.build_mutex.use_count() == 1)
+				it = clstate->m_program_registry.erase(it);
+			else
+				++it;
+		}
+		Context::ProgramRegistryEntry& entry = clstate->m_program_registry[key];
+		// on a hash collision the entry keeps referring to the other (live) program
+		if(entry.program.expired())
+			entry.program = program;
+	}
+	return program;
+}
+
+std::future<simple_cl::cl::Program> simple_cl::cl::Program::buildAsync(const std::string& source, const std::string& compiler_options, const std::shared_ptr<Context>& clstate)
+{
+	return std::async(std::launch::async, [source, compiler_options, clstate]() {
+		return Program{source, compiler_options, clstate};
+	});
+}
+
+std::vector<simple_cl::cl::Program> simple_cl::cl::Program::buildAll(const std::vector<SourceDesc>& sources, const std::shared_ptr<Context>& clstate)
+{
+	std::vector<std::unique_ptr<Program>> programs(sources.size());
+	std::vector<std::exception_ptr> errors(sources.size());
+	std::atomic<std::size_t> next_index{0ull};
+	auto worker = [&]() {
+		for(std::size_t i = next_index++; i < sources.size(); i = next_index++)
+		{
+			try
+			{
+				programs[i].reset(new Program{sources[i].source, sources[i].compiler_options, clstate});
+			}
+			catch(...)
+			{
+				errors[i] = std::current_exception();
+			}
+		}
+	};
+
+	const std::size_t num_threads{std::min(sources.size(), std::max(std::size_t{1ull}, static_cast<std::size_t>(std::thread::hardware_concurrency())))};
+	std::vector<std::thread> threads;
+	// the calling thread works as well, failing to spawn more threads just reduces parallelism
+	for(std::size_t t = 1ull; t < num_threads; ++t)
+	{
+		try
+		{
+			threads.emplace_back(worker);
+		}
+		catch(const std::system_error&)
+		{
+			break;
+		}
+	}
+	worker();
+	for(std::thread& thread : threads)
+		thread.join();
+
+	for(const std::exception_ptr& error : errors)
+		if(error)
+			std::rethrow_exception(error);
+	std::vector<Program> result;
+	result.reserve(programs.size());
+	for(std::unique_ptr<Program>& program : programs)
+		result.push_back(std::move(*program));
+	return result;
+}
+
+void simple_cl::cl::Program::setBinaryCacheDirectory(const std::string& directory)
+{
+	BinaryCacheSettings& settings = binary_cache_settings();
+	std::lock_guard<std::mutex> lock(settings.mutex);
+	settings.directory = directory;
+}
+
+void simple_cl::cl::Program::createKernels(const std::vector<cl_device_id>& device_ids)
+{
+	// extract kernels and parameters
+	cl_int res;
+	std::size_t num_kernels{0};
+	CL_EX(clGetProgramInfo(m_cl_program, CL_PROGRAM_NUM_KERNELS, sizeof(std::size_t), &num_kernels, nullptr));
+	std::size_t kernel_name_string_length{0};
+	CL_EX(clGetProgramInfo(m_cl_program, CL_PROGRAM_KERNEL_NAMES, 0ull, nullptr, &kernel_name_string_length));
+	std::unique_ptr<char[]> kernel_name_string{new char[kernel_name_string_length]};
+	CL_EX(clGetProgramInfo(m_cl_program, CL_PROGRAM_KERNEL_NAMES, kernel_name_string_length, kernel_name_string.get(), nullptr));
+	std::vector<std::string> kernel_names{util::string_split(std::string{kernel_name_string.get()}, ';')};
+	if(kernel_names.size() != num_kernels)
+		throw std::logic_error("Number of kernels in program does not match reported number of kernels.");
+
+	// create kernels
+	for(std::size_t i = 0; i < num_kernels; ++i)
+	{
+		cl_kernel kernel = clCreateKernel(m_cl_program, kernel_names[i].c_str(), &res); if(res != CL_SUCCESS) throw CLException{res, __LINE__, __FILE__, "clCreateKernel failed."};			
+		const std::uint64_t name_hash{KernelName{kernel_names[i]}.hash()};
+		if(m_kernels.count(name_hash))
+		{
+			CL(clReleaseKernel(kernel));
+			throw std::runtime_error("[Program]: Kernel name hash collision: " + kernel_names[i]);
+		}
+		CLKernel& kernel_record = m_kernels[name_hash] = CLKernel{i, kernel_names[i], {}, kernel, {}};
+		// query per-kernel info for every device
+		for(cl_device_id device_id : device_ids)
+		{
+			CLKernelInfo kinfo;
+			std::size_t sz{0ull};
+			cl_ulong usz{0ul};
+			CL_EX(clGetKernelWorkGroupInfo(kernel, device_id, CL_KERNEL_WORK_GROUP_SIZE, sizeof(std::size_t), &sz, nullptr));
+			kinfo.max_work_group_size = sz; sz = 0ull;
+			CL_EX(clGetKernelWorkGroupInfo(kernel, device_id, CL_KERNEL_LOCAL_MEM_SIZE, sizeof(cl_ulong), &usz, nullptr));
+			kinfo.local_memory_usage = std::size_t{usz}; usz = 0ul;
+			CL_EX(clGetKernelWorkGroupInfo(kernel, device_id, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(std::size_t), &sz, nullptr));
+			kinfo.preferred_work_group_size_multiple = sz; sz = 0ull;
+			CL_EX(clGetKernelWorkGroupInfo(kernel, device_id, CL_KERNEL_PRIVATE_MEM_SIZE, sizeof(cl_ulong), &usz, nullptr));
+			kinfo.private_memory_usage = std::size_t{usz};
+			kernel_record.kernel_info.push_back(kinfo);
+		}
+	}
+}
+
 simple_cl::cl::Program::~Program()
 {
 	cleanup();
@@ -584,9 +1765,13 @@ simple_cl::cl::Program::Program(Program&& other) noexcept :
 	m_cl_state{std::move(other.m_cl_state)},
 	m_cl_program{other.m_cl_program},
 	m_options{std::move(other.m_options)},
-	m_event_cache{std::move(other.m_event_cache)}
+	m_uid{other.m_uid},
+	m_concurrent_invocation{other.m_concurrent_invocation},
+	m_invoke_state{std::move(other.m_invoke_state)},
+	m_thread_invoke_states{std::move(other.m_thread_invoke_states)}
 {
-	m_event_cache.clear();
+	// the id moves with the invoke states, the moved-from instance gets a fresh one
+	other.m_uid = next_program_uid();
 	other.m_kernels.clear();
 	other.m_cl_program = nullptr;	
 }
@@ -602,15 +1787,27 @@ simple_cl::cl::Program& simple_cl::cl::Program::operator=(Program&& other) noexc
 	m_options = std::move(other.m_options);
 	std::swap(m_kernels, other.m_kernels);
 	std::swap(m_cl_program, other.m_cl_program);
-	m_event_cache.clear();
-	other.m_event_cache.clear();
-	std::swap(m_event_cache, other.m_event_cache);
+	// the id moves with the invoke states, the moved-from instance gets a fresh one
+	m_uid = other.m_uid;
+	other.m_uid = next_program_uid();
+	m_concurrent_invocation = other.m_concurrent_invocation;
+	std::swap(m_invoke_state, other.m_invoke_state);
+	m_thread_invoke_states = std::move(other.m_thread_invoke_states);
 
 	return *this;
 }
 
 void simple_cl::cl::Program::cleanup() noexcept
 {
+	if(m_thread_invoke_states)
+	{
+		std::lock_guard<std::mutex> lock(m_thread_invoke_states->mutex);
+		for(auto& thread_state : m_thread_invoke_states->states)
+			for(CLKernel& k : thread_state.second->kernels)
+				if(k.kernel)
+					clReleaseKernel(k.kernel);
+		m_thread_invoke_states->states.clear();
+	}
 	for(auto& k : m_kernels)
 	{
 		if(k.second.kernel)
@@ -619,81 +1816,397 @@ void simple_cl::cl::Program::cleanup() noexcept
 	m_kernels.clear();
 	if(m_cl_program)
 		clReleaseProgram(m_cl_program);
+	m_cl_program = nullptr;
 }
 
-simple_cl::cl::Event simple_cl::cl::Program::invoke(cl_kernel kernel, const std::vector<cl_event>& dep_events, const ExecParams& exparams)
+simple_cl::cl::Event simple_cl::cl::Program::invoke(cl_kernel kernel, const EventList& dep_events, const ExecParams& exparams)
 {
 	cl_event ev{nullptr};
 	CL_EX(clEnqueueNDRangeKernel(
-		m_cl_state->command_queue(),
+		m_cl_state->command_queue(exparams.queue),
 		kernel,
 		static_cast<cl_uint>(exparams.work_dim),
 		exparams.work_offset,
 		exparams.global_work_size,
 		exparams.local_work_size,
 		static_cast<cl_uint>(dep_events.size()),
-		dep_events.size() > 0ull ? dep_events.data() : nullptr,
-		&ev
+		dep_events.data(),
+		exparams.queue.events_enabled() ? &ev : nullptr
 	));
 	return Event{ev};
 }
 
-void simple_cl::cl::Program::setKernelArgsImpl(const std::string& name, std::size_t index, std::size_t arg_size, const void* arg_data_ptr)
+void simple_cl::cl::Program::setKernelArgsImpl(InvokeState& state, const CLKernelHandle& kernel, std::size_t index, std::size_t arg_size, const void* arg_data_ptr, std::uint64_t arg_identity)
+{	
+	if(!kernel.m_kernel_record)
+	{
+		CL_EX(clSetKernelArg(kernel.m_kernel, static_cast<cl_uint>(index), arg_size, arg_data_ptr));
+		state.set_calls.fetch_add(1ull, std::memory_order_relaxed);
+		return;
+	}
+
+	std::vector<KernelArgShadow>& shadows = kernel.m_kernel_record->arg_shadow;
+	if(index >= shadows.size())
+		shadows.resize(index + 1ull);
+	KernelArgShadow& shadow = shadows[index];
+	const bool has_data{arg_data_ptr != nullptr};
+	// equal bytes are not enough for memory objects: a new cl_mem may be allocated at the address of a released one
+	if(shadow.valid && shadow.identity == arg_identity && shadow.size == arg_size && shadow.has_data == has_data && (!has_data || std::memcmp(shadow.bytes.data(), arg_data_ptr, arg_size) == 0))
+	{
+		state.elided_calls.fetch_add(1ull, std::memory_order_relaxed);
+		return;
+	}
+
+	// the shadow must not claim a value the kernel might not hold if the call fails
+	shadow.valid = false;
+	CL_EX(clSetKernelArg(kernel.m_kernel, static_cast<cl_uint>(index), arg_size, arg_data_ptr));
+	state.set_calls.fetch_add(1ull, std::memory_order_relaxed);
+	shadow.size = arg_size;
+	shadow.identity = arg_identity;
+	shadow.has_data = has_data;
+	if(has_data)
+		shadow.bytes.assign(static_cast<const unsigned char*>(arg_data_ptr), static_cast<const unsigned char*>(arg_data_ptr) + arg_size);
+	else
+		shadow.bytes.clear();
+	shadow.valid = true;
+}
+
+simple_cl::cl::Program::KernelArgStats simple_cl::cl::Program::getKernelArgStats() const
 {
-	try
+	KernelArgStats stats;
+	if(m_invoke_state)
 	{
-		CL_EX(clSetKernelArg(m_kernels.at(name).kernel, static_cast<cl_uint>(index), arg_size, arg_data_ptr));
+		stats.set_calls = m_invoke_state->set_calls.load(std::memory_order_relaxed);
+		stats.elided_calls = m_invoke_state->elided_calls.load(std::memory_order_relaxed);
 	}
-	catch(const std::out_of_range&) // kernel name wasn't found
+	if(m_thread_invoke_states)
 	{
-		throw std::runtime_error("[Program]: Unknown kernel name");
+		std::lock_guard<std::mutex> lock(m_thread_invoke_states->mutex);
+		for(const auto& thread_state : m_thread_invoke_states->states)
+		{
+			stats.set_calls += thread_state.second->set_calls.load(std::memory_order_relaxed);
+			stats.elided_calls += thread_state.second->elided_calls.load(std::memory_order_relaxed);
+		}
 	}
-	catch(...)
+	return stats;
+}
+
+void simple_cl::cl::Program::resetKernelArgStats()
+{
+	if(m_invoke_state)
 	{
-		throw;
+		m_invoke_state->set_calls.store(0ull, std::memory_order_relaxed);
+		m_invoke_state->elided_calls.store(0ull, std::memory_order_relaxed);
+	}
+	if(m_thread_invoke_states)
+	{
+		std::lock_guard<std::mutex> lock(m_thread_invoke_states->mutex);
+		for(auto& thread_state : m_thread_invoke_states->states)
+		{
+			thread_state.second->set_calls.store(0ull, std::memory_order_relaxed);
+			thread_state.second->elided_calls.store(0ull, std::memory_order_relaxed);
+		}
 	}
 }
 
-void simple_cl::cl::Program::setKernelArgsImpl(cl_kernel kernel, std::size_t index, std::size_t arg_size, const void* arg_data_ptr)
-{	
-	CL_EX(clSetKernelArg(kernel, static_cast<cl_uint>(index), arg_size, arg_data_ptr));
+void simple_cl::cl::Program::setConcurrentInvocation(bool enabled)
+{
+	m_concurrent_invocation = enabled;
 }
 
-simple_cl::cl::Program::CLKernelHandle simple_cl::cl::Program::getKernel(const std::string& name) const
+simple_cl::cl::Program::InvokeState& simple_cl::cl::Program::invokeState()
 {
-	try
+	if(!m_concurrent_invocation)
+		return *m_invoke_state;
+
+	assert(m_thread_invoke_states);
+	// thread local lookup by program id. Ids are never reused, so entries of dead programs are never hit, only pruned.
+	struct CachedInvokeState
+	{
+		std::weak_ptr<ThreadInvokeStates> owner;
+		InvokeState* state;
+	};
+	static thread_local std::unordered_map<std::uint64_t, CachedInvokeState> cached_states;
+	static thread_local std::size_t prune_threshold{16ull};
+	auto it = cached_states.find(m_uid);
+	if(it != cached_states.end())
+		return *it->second.state;
+
+	// first invoke of this program on the calling thread
+	InvokeState* state{nullptr};
 	{
-		const auto& kernel{m_kernels.at(name)};
-		return CLKernelHandle{kernel.kernel, kernel.kernel_info};
+		std::lock_guard<std::mutex> lock(m_thread_invoke_states->mutex);
+		std::unique_ptr<InvokeState>& thread_state = m_thread_invoke_states->states[std::this_thread::get_id()];
+		if(!thread_state)
+		{
+			thread_state.reset(new InvokeState);
+			thread_state->kernels.resize(m_kernels.size());
+		}
+		state = thread_state.get();
+	}
+	if(cached_states.size() >= prune_threshold)
+	{
+		for(auto entry = cached_states.begin(); entry != cached_states.end();)
+			entry = entry->second.owner.expired() ? cached_states.erase(entry) : std::next(entry);
+		prune_threshold = std::max(std::size_t{16ull}, std::size_t{2ull} * cached_states.size());
 	}
-	catch(const std::out_of_range&)
+	cached_states[m_uid] = CachedInvokeState{m_thread_invoke_states, state};
+	return *state;
+}
+
+simple_cl::cl::Program::CLKernelHandle simple_cl::cl::Program::invokeKernel(InvokeState& state, const CLKernelHandle& kernel)
+{
+	if(!m_concurrent_invocation)
+		return kernel;
+
+	assert(kernel.m_kernel_record && kernel.m_kernel_record->id < state.kernels.size());
+	CLKernel& thread_kernel = state.kernels[kernel.m_kernel_record->id];
+	if(!thread_kernel.kernel)
+	{
+		cl_int res;
+		cl_kernel new_kernel = clCreateKernel(m_cl_program, kernel.m_kernel_record->name.c_str(), &res);
+		if(res != CL_SUCCESS)
+			throw CLException{res, __LINE__, __FILE__, "clCreateKernel failed."};
+		thread_kernel.id = kernel.m_kernel_record->id;
+		thread_kernel.kernel = new_kernel;
+	}
+	return CLKernelHandle{thread_kernel.kernel, &thread_kernel};
+}
+
+simple_cl::cl::Program::CLKernelHandle simple_cl::cl::Program::getKernel(const KernelName& name) const
+{
+	// single lookup by the precomputed hash, the name comparison guards against unknown names with colliding hashes
+	auto it = m_kernels.find(name.hash());
+	if(it == m_kernels.end() || it->second.name.compare(0ull, std::string::npos, name.c_str(), name.size()) != 0)
+		throw std::runtime_error("[Program]: Unknown kernel name");
+	return CLKernelHandle{it->second.kernel, &it->second};
+}
+
+simple_cl::cl::Program::CLKernelInfo simple_cl::cl::Program::getKernelInfo(const KernelName& name, std::size_t device_index) const
+{
+	return getKernel(name).getKernelInfo(device_index);
+}
+
+simple_cl::cl::Program::CLKernelInfo simple_cl::cl::Program::getKernelInfo(const CLKernelHandle& kernel, std::size_t device_index) const
+{
+	assert(kernel.m_kernel);
+	return kernel.getKernelInfo(device_index);
+}
+
+cl_kernel simple_cl::cl::Program::createKernelCopy(const CLKernelHandle& kernel, std::size_t num_args) const
+{
+	assert(kernel.m_kernel_record);
+	cl_int res;
+	cl_kernel kernel_copy = clCreateKernel(m_cl_program, kernel.m_kernel_record->name.c_str(), &res);
+	if(res != CL_SUCCESS)
+		throw CLException{res, __LINE__, __FILE__, "clCreateKernel failed."};
+	cl_uint kernel_num_args{0u};
+	res = clGetKernelInfo(kernel_copy, CL_KERNEL_NUM_ARGS, sizeof(cl_uint), &kernel_num_args, nullptr);
+	if(res != CL_SUCCESS || kernel_num_args != num_args)
 	{
-		throw std::runtime_error("Unknown kernel name.");
+		CL(clReleaseKernel(kernel_copy));
+		if(res != CL_SUCCESS)
+			throw CLException{res, __LINE__, __FILE__, "clGetKernelInfo failed."};
+		throw std::runtime_error("[Program]: Number of bound arguments does not match the kernel signature.");
 	}
+	return kernel_copy;
 }
 
-simple_cl::cl::Program::CLKernelInfo simple_cl::cl::Program::getKernelInfo(const std::string& name) const
+// -------------------------- class Program::BoundKernel
+
+simple_cl::cl::Program::BoundKernel::BoundKernel(cl_kernel kernel, const ExecParams& exec_params, const std::shared_ptr<Context>& clstate, std::vector<std::type_index> arg_types) :
+	m_kernel{kernel},
+	m_exec_params(exec_params),
+	m_cl_state{clstate},
+	m_queue{nullptr},
+	m_arg_types{std::move(arg_types)}
 {
 	try
 	{
-		return m_kernels.at(name).kernel_info;
+		m_queue = m_cl_state->command_queue(m_exec_params.queue);
 	}
-	catch(const std::out_of_range&)
+	catch(...)
 	{
-		throw std::runtime_error("Unknown kernel name.");
+		cleanup();
+		throw;
 	}
 }
 
-simple_cl::cl::Program::CLKernelInfo simple_cl::cl::Program::getKernelInfo(const CLKernelHandle& kernel) const
+simple_cl::cl::Program::BoundKernel::~BoundKernel()
+{
+	cleanup();
+}
+
+simple_cl::cl::Program::BoundKernel::BoundKernel(BoundKernel&& other) noexcept :
+	m_kernel{other.m_kernel},
+	m_exec_params(other.m_exec_params),
+	m_cl_state{std::move(other.m_cl_state)},
+	m_queue{other.m_queue},
+	m_arg_types{std::move(other.m_arg_types)}
+{
+	other.m_kernel = nullptr;
+	other.m_queue = nullptr;
+}
+
+simple_cl::cl::Program::BoundKernel& simple_cl::cl::Program::BoundKernel::operator=(BoundKernel&& other) noexcept
+{
+	if(this == &other)
+		return *this;
+
+	cleanup();
+	std::swap(m_kernel, other.m_kernel);
+	m_exec_params = other.m_exec_params;
+	m_cl_state = std::move(other.m_cl_state);
+	m_queue = other.m_queue;
+	other.m_queue = nullptr;
+	m_arg_types = std::move(other.m_arg_types);
+
+	return *this;
+}
+
+void simple_cl::cl::Program::BoundKernel::cleanup() noexcept
+{
+	if(m_kernel)
+		clReleaseKernel(m_kernel);
+	m_kernel = nullptr;
+	m_queue = nullptr;
+}
+
+void simple_cl::cl::Program::BoundKernel::setArgImpl(std::size_t index, std::size_t arg_size, const void* arg_data_ptr)
+{
+	assert(m_kernel);
+	CL_EX(clSetKernelArg(m_kernel, static_cast<cl_uint>(index), arg_size, arg_data_ptr));
+}
+
+void simple_cl::cl::Program::BoundKernel::setExecParams(const ExecParams& exec_params)
+{
+	assert(m_cl_state);
+	// resolve the queue first so that a bad queue leaves the object unchanged
+	cl_command_queue queue{m_cl_state->command_queue(exec_params.queue)};
+	m_exec_params = exec_params;
+	m_queue = queue;
+}
+
+simple_cl::cl::Event simple_cl::cl::Program::BoundKernel::launch()
+{
+	return enqueue(EventList{});
+}
+
+simple_cl::cl::Event simple_cl::cl::Program::BoundKernel::enqueue(const EventList& dep_events)
 {
-	assert(kernel.m_kernel);
-	return kernel.m_kernel_info;
+	assert(m_kernel);
+	cl_event ev{nullptr};
+	CL_EX(clEnqueueNDRangeKernel(
+		m_queue,
+		m_kernel,
+		static_cast<cl_uint>(m_exec_params.work_dim),
+		m_exec_params.work_offset,
+		m_exec_params.global_work_size,
+		m_exec_params.local_work_size,
+		static_cast<cl_uint>(dep_events.size()),
+		dep_events.data(),
+		m_exec_params.queue.events_enabled() ? &ev : nullptr
+	));
+	return Event{ev};
 }
 
 #pragma endregion
 
 #pragma region class Event
 // class Event
+
+namespace
+{
+	// Runs host continuations of events on a single worker thread, away from the OpenCL runtime's callback thread.
+	class CompletionDispatcher
+	{
+	public:
+		CompletionDispatcher() :
+			m_stop{false},
+			m_worker{[this]() { run(); }}
+		{
+		}
+
+		~CompletionDispatcher()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_cond.notify_one();
+			m_worker.join();
+		}
+
+		CompletionDispatcher(const CompletionDispatcher&) = delete;
+		CompletionDispatcher& operator=(const CompletionDispatcher&) = delete;
+
+		static CompletionDispatcher& instance()
+		{
+			static CompletionDispatcher dispatcher;
+			return dispatcher;
+		}
+
+		void post(std::function<void()> task)
+		{
+			// notify under the lock, the runtime may call back while the dispatcher shuts down
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.push_back(std::move(task));
+			m_cond.notify_one();
+		}
+
+	private:
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while(true)
+			{
+				m_cond.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+				// pending continuations are drained before shutting down
+				if(m_tasks.empty())
+					return;
+				std::function<void()> task{std::move(m_tasks.front())};
+				m_tasks.pop_front();
+				lock.unlock();
+				try
+				{
+					task();
+				}
+				catch(const std::exception& e)
+				{
+					std::cerr << "[Event]: Exception in event continuation: " << e.what() << std::endl;
+				}
+				catch(...)
+				{
+					std::cerr << "[Event]: Unknown exception in event continuation." << std::endl;
+				}
+				lock.lock();
+			}
+		}
+
+		std::mutex m_mutex;
+		std::condition_variable m_cond;
+		std::deque<std::function<void()>> m_tasks;
+		bool m_stop;
+		std::thread m_worker;
+	};
+
+	void CL_CALLBACK dispatch_continuation(cl_event, cl_int status, void* user_data)
+	{
+		std::unique_ptr<simple_cl::cl::Event::Callback> callback{static_cast<simple_cl::cl::Event::Callback*>(user_data)};
+		simple_cl::cl::Event::Callback cb{std::move(*callback)};
+		CompletionDispatcher::instance().post([cb, status]() { cb(status); });
+	}
+
+	void CL_CALLBACK fulfill_promise(cl_event, cl_int status, void* user_data)
+	{
+		// runs on the runtime's callback thread, setting the promise is cheap and never blocks
+		std::unique_ptr<std::promise<void>> promise{static_cast<std::promise<void>*>(user_data)};
+		if(status < 0)
+			promise->set_exception(std::make_exception_ptr(simple_cl::CLException{status, __LINE__, __FILE__, "[Event]: Command terminated abnormally."}));
+		else
+			promise->set_value();
+	}
+}
 simple_cl::cl::Event::Event(cl_event ev) :
 	m_event{ev}
 {	
@@ -723,8 +2236,11 @@ simple_cl::cl::Event& simple_cl::cl::Event::operator=(const Event& other)
 	if(this == &other)
 		return *this;
 
+	if(other.m_event)
+		CL_EX(clRetainEvent(other.m_event));
+	if(m_event)
+		CL_EX(clReleaseEvent(m_event));
 	m_event = other.m_event;
-	CL_EX(clRetainEvent(m_event));
 
 	return *this;
 }
@@ -741,25 +2257,189 @@ simple_cl::cl::Event& simple_cl::cl::Event::operator=(Event&& other) noexcept
 
 void simple_cl::cl::Event::wait() const
 {
+	// empty events stem from event-free submissions, see Queue::without_events()
+	if(!m_event)
+		return;
 	CL_EX(clWaitForEvents(1, &m_event));
 }
 
-void simple_cl::cl::Event::wait_for_events_(const std::vector<cl_event>& events)
+simple_cl::cl::Event::ProfilingInfo simple_cl::cl::Event::profiling_info() const
+{
+	if(!m_event)
+		throw std::runtime_error("[Event]: Profiling information of an empty event requested.");
+	// timestamps are only valid once the command has completed
+	wait();
+	ProfilingInfo info;
+	CL_EX(clGetEventProfilingInfo(m_event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &info.queued, nullptr));
+	CL_EX(clGetEventProfilingInfo(m_event, CL_PROFILING_COMMAND_SUBMIT, sizeof(cl_ulong), &info.submit, nullptr));
+	CL_EX(clGetEventProfilingInfo(m_event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &info.start, nullptr));
+	CL_EX(clGetEventProfilingInfo(m_event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &info.end, nullptr));
+	return info;
+}
+
+void simple_cl::cl::Event::then(Callback callback) const
 {
+	if(!callback)
+		throw std::runtime_error("[Event]: Empty continuation passed.");
+	// empty events stem from event-free submissions, there is nothing to wait for
+	if(!m_event)
+	{
+		CompletionDispatcher::instance().post([callback]() { callback(CL_COMPLETE); });
+		return;
+	}
+	// make sure the dispatcher is alive before the runtime may call back
+	CompletionDispatcher::instance();
+	std::unique_ptr<Callback> payload{new Callback{std::move(callback)}};
+	CL_EX(clSetEventCallback(m_event, CL_COMPLETE, dispatch_continuation, payload.get()));
+	// ownership passed to dispatch_continuation
+	payload.release();
+}
+
+std::future<void> simple_cl::cl::Event::to_future() const
+{
+	std::unique_ptr<std::promise<void>> promise{new std::promise<void>{}};
+	std::future<void> future{promise->get_future()};
+	if(!m_event)
+	{
+		promise->set_value();
+		return future;
+	}
+	CL_EX(clSetEventCallback(m_event, CL_COMPLETE, fulfill_promise, promise.get()));
+	// ownership passed to fulfill_promise
+	promise.release();
+	return future;
+}
+
+void simple_cl::cl::Event::wait_for_events_(const EventList& events)
+{
+	// clWaitForEvents rejects empty lists
+	if(events.empty())
+		return;
 	CL_EX(clWaitForEvents(static_cast<cl_uint>(events.size()), events.data()));
 }
 #pragma endregion
 
+#pragma region class UserEvent
+// class UserEvent
+
+namespace
+{
+	cl_event create_user_event(const std::shared_ptr<simple_cl::cl::Context>& clstate)
+	{
+		if(!clstate)
+			throw std::runtime_error("[UserEvent]: Invalid context.");
+		cl_int res;
+		cl_event ev = clCreateUserEvent(clstate->context(), &res);
+		CL_EX(res);
+		return ev;
+	}
+}
+
+simple_cl::cl::UserEvent::UserEvent(const std::shared_ptr<Context>& clstate) :
+	Event{create_user_event(clstate)}
+{
+}
+
+void simple_cl::cl::UserEvent::set_complete() const
+{
+	CL_EX(clSetUserEventStatus(m_event, CL_COMPLETE));
+}
+
+void simple_cl::cl::UserEvent::set_failed(cl_int error) const
+{
+	if(error >= 0)
+		throw std::runtime_error("[UserEvent]: Execution status of a failed event must be a negative error code.");
+	CL_EX(clSetUserEventStatus(m_event, error));
+}
+#pragma endregion
+
+#pragma region class EventList
+// class EventList
+
+namespace
+{
+	// Overflow storage of long event lists, reused by the next list of the same thread.
+	struct ScratchEvents
+	{
+		std::vector<cl_event> events;
+		bool in_use = false;
+	};
+
+	ScratchEvents& thread_scratch_events()
+	{
+		static thread_local ScratchEvents scratch;
+		return scratch;
+	}
+}
+
+void simple_cl::cl::EventList::grow()
+{
+	if(!m_overflow)
+	{
+		// the scratch is taken if another list of this thread spilled already
+		ScratchEvents& scratch = thread_scratch_events();
+		if(!scratch.in_use)
+		{
+			scratch.in_use = true;
+			m_overflow = &scratch.events;
+			m_owns_overflow = false;
+		}
+		else
+		{
+			m_overflow = new std::vector<cl_event>;
+			m_owns_overflow = true;
+		}
+		try
+		{
+			m_overflow->assign(m_inline, m_inline + m_size);
+		}
+		catch(...)
+		{
+			release_overflow();
+			throw;
+		}
+	}
+	// resize preserves the first m_size handles
+	m_overflow->resize(2ull * m_capacity);
+	m_data = m_overflow->data();
+	m_capacity = m_overflow->size();
+}
+
+void simple_cl::cl::EventList::release_overflow() noexcept
+{
+	if(m_owns_overflow)
+		delete m_overflow;
+	else
+		thread_scratch_events().in_use = false;
+	m_overflow = nullptr;
+	m_owns_overflow = false;
+	m_data = m_inline;
+	m_capacity = constants::EVENT_LIST_INLINE_CAPACITY;
+}
+#pragma endregion
+
 #pragma region class Buffer
 // class Buffer
 
+namespace
+{
+	// Process-unique ids of memory objects, see Buffer::arg_identity(). 0 is reserved for arguments without identity.
+	std::uint64_t next_memory_uid() noexcept
+	{
+		static std::atomic<std::uint64_t> next_uid{1ull};
+		return next_uid.fetch_add(1ull, std::memory_order_relaxed);
+	}
+}
+
 simple_cl::cl::Buffer::Buffer(std::size_t size, const MemoryFlags& flags, const std::shared_ptr<Context>& clstate, void* hostptr) :
 	m_cl_memory{nullptr},
+	m_uid{next_memory_uid()},
+	m_parent{nullptr},
+	m_origin{0ull},
 	m_size{0ull},
 	m_cl_state{clstate},
 	m_flags{flags},
-	m_hostptr{nullptr},
-	m_event_cache{}
+	m_hostptr{nullptr}
 {	
 	cl_int err{CL_SUCCESS};
 	cl_mem_flags clflags{static_cast<cl_mem_flags>(flags.device_access) | static_cast<cl_mem_flags>(flags.host_access) | static_cast<cl_mem_flags>(flags.host_pointer_option)};
@@ -771,21 +2451,41 @@ simple_cl::cl::Buffer::Buffer(std::size_t size, const MemoryFlags& flags, const
 	m_hostptr = (flags.host_pointer_option == HostPointerOption::UseHostPtr || flags.host_pointer_option == HostPointerOption::CopyHostPtr) ? hostptr : nullptr;
 }
 
+simple_cl::cl::Buffer::Buffer(cl_mem sub_buffer, cl_mem parent, std::size_t origin, std::size_t size, const MemoryFlags& flags, const std::shared_ptr<Context>& clstate, void* hostptr) :
+	m_cl_memory{sub_buffer},
+	m_uid{next_memory_uid()},
+	m_parent{parent},
+	m_origin{origin},
+	m_flags{flags},
+	m_hostptr{hostptr},
+	m_size{size},
+	m_cl_state{clstate}
+{
+	CL_EX(clRetainMemObject(m_parent));
+}
+
 simple_cl::cl::Buffer::~Buffer() noexcept
 {
 	if(m_cl_memory)
 		CL(clReleaseMemObject(m_cl_memory));
+	if(m_parent)
+		CL(clReleaseMemObject(m_parent));
 }
 
 simple_cl::cl::Buffer::Buffer(Buffer&& other) noexcept :
 	m_cl_memory{nullptr},
+	m_uid{next_memory_uid()},
+	m_parent{nullptr},
+	m_origin{0ull},
 	m_size{0ull},
 	m_cl_state{nullptr},
 	m_flags{},
-	m_hostptr{nullptr},
-	m_event_cache{}
+	m_hostptr{nullptr}
 {
 	std::swap(m_cl_memory, other.m_cl_memory);
+	std::swap(m_uid, other.m_uid);
+	std::swap(m_parent, other.m_parent);
+	std::swap(m_origin, other.m_origin);
 	std::swap(m_size, other.m_size);
 	std::swap(m_cl_state, other.m_cl_state);
 	std::swap(m_flags, other.m_flags);
@@ -798,16 +2498,18 @@ simple_cl::cl::Buffer& simple_cl::cl::Buffer::operator=(Buffer&& other) noexcept
 		return *this;
 	
 	std::swap(m_cl_memory, other.m_cl_memory);
+	std::swap(m_uid, other.m_uid);
+	std::swap(m_parent, other.m_parent);
+	std::swap(m_origin, other.m_origin);
 	std::swap(m_size, other.m_size);
 	std::swap(m_cl_state, other.m_cl_state);
 	std::swap(m_flags, other.m_flags);
 	std::swap(m_hostptr, other.m_hostptr);
-	m_event_cache.clear();
 
 	return *this;
 }
 
-simple_cl::cl::Event simple_cl::cl::Buffer::buf_write(const void* data, std::size_t length, std::size_t offset, bool invalidate)
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_write(const EventList& dep_events, const void* data, std::size_t length, std::size_t offset, bool invalidate, const Queue& queue)
 {
 	if(offset + length > m_size)
 		throw std::out_of_range("[Buffer]: Buffer write failed. Input offset + length out of range.");
@@ -817,15 +2519,15 @@ simple_cl::cl::Event simple_cl::cl::Buffer::buf_write(const void* data, std::siz
 	std::size_t _length = (length > 0ull ? length : m_size);
 	cl_int err{CL_SUCCESS};
 	cl_event unmap_event{nullptr};
-	void* bufptr = clEnqueueMapBuffer(m_cl_state->command_queue(), m_cl_memory, true, (invalidate ? CL_MAP_WRITE_INVALIDATE_REGION : CL_MAP_WRITE), _offset, _length, static_cast<cl_uint>(m_event_cache.size()), (m_event_cache.size() > 0ull? m_event_cache.data() : nullptr), nullptr, &err);
+	void* bufptr = clEnqueueMapBuffer(m_cl_state->command_queue(queue), m_cl_memory, true, (invalidate ? CL_MAP_WRITE_INVALIDATE_REGION : CL_MAP_WRITE), _offset, _length, static_cast<cl_uint>(dep_events.size()), dep_events.data(), nullptr, &err);
 	if(err != CL_SUCCESS)
 		throw CLException(err, __LINE__, __FILE__, "[Buffer]: Write failed.");
 	std::memcpy(bufptr, data, _length);
-	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(), m_cl_memory, bufptr, 0u, nullptr, &unmap_event));
+	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(queue), m_cl_memory, bufptr, 0u, nullptr, queue.events_enabled() ? &unmap_event : nullptr));
 	return Event{unmap_event};
 }
 
-simple_cl::cl::Event simple_cl::cl::Buffer::buf_read(void* data, std::size_t length, std::size_t offset) const
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_read(const EventList& dep_events, void* data, std::size_t length, std::size_t offset, const Queue& queue) const
 {
 	if(offset + length > m_size)
 		throw std::out_of_range("[Buffer]: Buffer read failed. Input offset + length out of range.");
@@ -835,27 +2537,184 @@ simple_cl::cl::Event simple_cl::cl::Buffer::buf_read(void* data, std::size_t len
 	std::size_t _length = (length > 0ull ? length : m_size);
 	cl_int err{CL_SUCCESS};
 	cl_event unmap_event{nullptr};
-	void* bufptr = clEnqueueMapBuffer(m_cl_state->command_queue(), m_cl_memory, true, CL_MAP_READ, _offset, _length, static_cast<cl_uint>(m_event_cache.size()), (m_event_cache.size() > 0ull ? m_event_cache.data() : nullptr), nullptr, &err);
+	void* bufptr = clEnqueueMapBuffer(m_cl_state->command_queue(queue), m_cl_memory, true, CL_MAP_READ, _offset, _length, static_cast<cl_uint>(dep_events.size()), dep_events.data(), nullptr, &err);
 	if(err != CL_SUCCESS)
 		throw CLException(err, __LINE__, __FILE__, "[Buffer]: Read failed.");
 	std::memcpy(data, bufptr, _length);
-	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(), m_cl_memory, bufptr, 0u, nullptr, &unmap_event));
+	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(queue), m_cl_memory, bufptr, 0u, nullptr, queue.events_enabled() ? &unmap_event : nullptr));
 	return Event{unmap_event};
 }
 
-void* simple_cl::cl::Buffer::map_buffer(std::size_t length, std::size_t offset, bool write, bool invalidate)
+namespace
+{
+	void CL_CALLBACK release_staging_memory(cl_event, cl_int, void* user_data)
+	{
+		delete static_cast<std::vector<unsigned char>*>(user_data);
+	}
+}
+
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_write_async(const EventList& dep_events, const void* data, std::size_t length, std::size_t offset, bool staged, const Queue& queue)
+{
+	if(offset + length > m_size)
+		throw std::out_of_range("[Buffer]: Buffer write failed. Input offset + length out of range.");
+	if(m_flags.host_access == HostAccess::ReadOnly || m_flags.host_access == HostAccess::NoAccess)
+		throw std::runtime_error("[Buffer]: Writing to a read only buffer is not allowed.");
+	std::size_t _offset = (length > 0ull ? offset : 0ull);
+	std::size_t _length = (length > 0ull ? length : m_size);
+	cl_event write_event{nullptr};
+	if(!staged)
+	{
+		CL_EX(clEnqueueWriteBuffer(m_cl_state->command_queue(queue), m_cl_memory, CL_FALSE, _offset, _length, data, static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &write_event : nullptr));
+		return Event{write_event};
+	}
+
+	std::unique_ptr<std::vector<unsigned char>> staging{new std::vector<unsigned char>(_length)};
+	std::memcpy(staging->data(), data, _length);
+	// the staging memory is released from the completion callback, so an event is required regardless of queue.events_enabled()
+	CL_EX(clEnqueueWriteBuffer(m_cl_state->command_queue(queue), m_cl_memory, CL_FALSE, _offset, _length, staging->data(), static_cast<cl_uint>(dep_events.size()), dep_events.data(), &write_event));
+	Event ev{write_event};
+	cl_int err = clSetEventCallback(write_event, CL_COMPLETE, release_staging_memory, staging.get());
+	if(err != CL_SUCCESS)
+	{
+		// the runtime may still read from the staging memory
+		CL(clWaitForEvents(1, &write_event));
+		throw CLException(err, __LINE__, __FILE__, "[Buffer]: Registering release of staging memory failed.");
+	}
+	// ownership passed to release_staging_memory
+	staging.release();
+	return queue.events_enabled() ? ev : Event{nullptr};
+}
+
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_read_async(const EventList& dep_events, void* data, std::size_t length, std::size_t offset, const Queue& queue) const
+{
+	if(offset + length > m_size)
+		throw std::out_of_range("[Buffer]: Buffer read failed. Input offset + length out of range.");
+	if(m_flags.host_access == HostAccess::WriteOnly || m_flags.host_access == HostAccess::NoAccess)
+		throw std::runtime_error("[Buffer]: Reading from a write only buffer is not allowed.");
+	std::size_t _offset = (length > 0ull ? offset : 0ull);
+	std::size_t _length = (length > 0ull ? length : m_size);
+	cl_event read_event{nullptr};
+	CL_EX(clEnqueueReadBuffer(m_cl_state->command_queue(queue), m_cl_memory, CL_FALSE, _offset, _length, data, static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &read_event : nullptr));
+	return Event{read_event};
+}
+
+namespace
+{
+	// Sub-buffer offset alignment in bytes which satisfies all devices of a context.
+	std::size_t context_sub_buffer_alignment(const simple_cl::cl::Context& context)
+	{
+		// mem_base_addr_align is given in bits
+		cl_uint align_bits{8u};
+		for(const simple_cl::cl::Context::CLDevice& device : context.get_selected_devices())
+			align_bits = std::max(align_bits, device.mem_base_addr_align);
+		return static_cast<std::size_t>(align_bits / 8u);
+	}
+
+	// Resolves zero pitches the way OpenCL does: tightly packed rows and slices.
+	simple_cl::cl::Buffer::RectPitch resolve_rect_pitch(const simple_cl::cl::Buffer::RectPitch& pitch, const simple_cl::cl::Buffer::RectRegion& region)
+	{
+		simple_cl::cl::Buffer::RectPitch resolved;
+		resolved.row_pitch = pitch.row_pitch ? pitch.row_pitch : region.width_bytes;
+		resolved.slice_pitch = pitch.slice_pitch ? pitch.slice_pitch : region.height * resolved.row_pitch;
+		return resolved;
+	}
+
+	// One past the last byte touched by a rectangular region.
+	std::size_t rect_end(const simple_cl::cl::Buffer::RectLayout& layout, const simple_cl::cl::Buffer::RectRegion& region)
+	{
+		if(!(region.width_bytes && region.height && region.depth))
+			throw std::runtime_error("[Buffer]: Rectangular region is empty.");
+		simple_cl::cl::Buffer::RectPitch pitch{resolve_rect_pitch(layout.pitch, region)};
+		return (layout.offset.offset_slices + region.depth - 1ull) * pitch.slice_pitch +
+			(layout.offset.offset_rows + region.height - 1ull) * pitch.row_pitch +
+			layout.offset.offset_bytes + region.width_bytes;
+	}
+}
+
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_write_rect(const EventList& dep_events, const void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking, const Queue& queue)
+{
+	if(m_flags.host_access == HostAccess::ReadOnly || m_flags.host_access == HostAccess::NoAccess)
+		throw std::runtime_error("[Buffer]: Writing to a read only buffer is not allowed.");
+	if(rect_end(buffer_layout, region) > m_size)
+		throw std::out_of_range("[Buffer]: Buffer write failed. Region out of range.");
+	std::size_t buffer_origin[]{buffer_layout.offset.offset_bytes, buffer_layout.offset.offset_rows, buffer_layout.offset.offset_slices};
+	std::size_t host_origin[]{host_layout.offset.offset_bytes, host_layout.offset.offset_rows, host_layout.offset.offset_slices};
+	std::size_t cl_region[]{region.width_bytes, region.height, region.depth};
+	cl_event write_event{nullptr};
+	CL_EX(clEnqueueWriteBufferRect(m_cl_state->command_queue(queue), m_cl_memory, blocking ? CL_TRUE : CL_FALSE, buffer_origin, host_origin, cl_region,
+		buffer_layout.pitch.row_pitch, buffer_layout.pitch.slice_pitch, host_layout.pitch.row_pitch, host_layout.pitch.slice_pitch, data,
+		static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &write_event : nullptr));
+	return Event{write_event};
+}
+
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_read_rect(const EventList& dep_events, void* data, const RectLayout& host_layout, const RectLayout& buffer_layout, const RectRegion& region, bool blocking, const Queue& queue) const
+{
+	if(m_flags.host_access == HostAccess::WriteOnly || m_flags.host_access == HostAccess::NoAccess)
+		throw std::runtime_error("[Buffer]: Reading from a write only buffer is not allowed.");
+	if(rect_end(buffer_layout, region) > m_size)
+		throw std::out_of_range("[Buffer]: Buffer read failed. Region out of range.");
+	std::size_t buffer_origin[]{buffer_layout.offset.offset_bytes, buffer_layout.offset.offset_rows, buffer_layout.offset.offset_slices};
+	std::size_t host_origin[]{host_layout.offset.offset_bytes, host_layout.offset.offset_rows, host_layout.offset.offset_slices};
+	std::size_t cl_region[]{region.width_bytes, region.height, region.depth};
+	cl_event read_event{nullptr};
+	CL_EX(clEnqueueReadBufferRect(m_cl_state->command_queue(queue), m_cl_memory, blocking ? CL_TRUE : CL_FALSE, buffer_origin, host_origin, cl_region,
+		buffer_layout.pitch.row_pitch, buffer_layout.pitch.slice_pitch, host_layout.pitch.row_pitch, host_layout.pitch.slice_pitch, data,
+		static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &read_event : nullptr));
+	return Event{read_event};
+}
+
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_copy(const EventList& dep_events, Buffer& dst, std::size_t length, std::size_t src_offset, std::size_t dst_offset, const Queue& queue) const
+{
+	std::size_t _src_offset = (length > 0ull ? src_offset : 0ull);
+	std::size_t _dst_offset = (length > 0ull ? dst_offset : 0ull);
+	std::size_t _length = (length > 0ull ? length : m_size);
+	if(_src_offset + _length > m_size || _dst_offset + _length > dst.m_size)
+		throw std::out_of_range("[Buffer]: Buffer copy failed. Offset + length out of range.");
+	cl_event copy_event{nullptr};
+	CL_EX(clEnqueueCopyBuffer(m_cl_state->command_queue(queue), m_cl_memory, dst.m_cl_memory, _src_offset, _dst_offset, _length, static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &copy_event : nullptr));
+	return Event{copy_event};
+}
+
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_copy_rect(const EventList& dep_events, Buffer& dst, const RectLayout& src_layout, const RectLayout& dst_layout, const RectRegion& region, const Queue& queue) const
+{
+	if(rect_end(src_layout, region) > m_size || rect_end(dst_layout, region) > dst.m_size)
+		throw std::out_of_range("[Buffer]: Buffer copy failed. Region out of range.");
+	std::size_t src_origin[]{src_layout.offset.offset_bytes, src_layout.offset.offset_rows, src_layout.offset.offset_slices};
+	std::size_t dst_origin[]{dst_layout.offset.offset_bytes, dst_layout.offset.offset_rows, dst_layout.offset.offset_slices};
+	std::size_t cl_region[]{region.width_bytes, region.height, region.depth};
+	cl_event copy_event{nullptr};
+	CL_EX(clEnqueueCopyBufferRect(m_cl_state->command_queue(queue), m_cl_memory, dst.m_cl_memory, src_origin, dst_origin, cl_region,
+		src_layout.pitch.row_pitch, src_layout.pitch.slice_pitch, dst_layout.pitch.row_pitch, dst_layout.pitch.slice_pitch,
+		static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &copy_event : nullptr));
+	return Event{copy_event};
+}
+
+simple_cl::cl::Event simple_cl::cl::Buffer::buf_fill(const EventList& dep_events, const void* pattern, std::size_t pattern_size, std::size_t offset, std::size_t length, const Queue& queue)
+{
+	std::size_t _offset = (length > 0ull ? offset : 0ull);
+	std::size_t _length = (length > 0ull ? length : m_size);
+	if(_offset + _length > m_size)
+		throw std::out_of_range("[Buffer]: Buffer fill failed. Offset + length out of range.");
+	if(_length % pattern_size != 0ull)
+		throw std::runtime_error("[Buffer]: Buffer fill failed. Length is not a multiple of the pattern size.");
+	cl_event fill_event{nullptr};
+	CL_EX(clEnqueueFillBuffer(m_cl_state->command_queue(queue), m_cl_memory, pattern, pattern_size, _offset, _length, static_cast<cl_uint>(dep_events.size()), dep_events.data(), queue.events_enabled() ? &fill_event : nullptr));
+	return Event{fill_event};
+}
+
+void* simple_cl::cl::Buffer::map_buffer(const EventList& dep_events, std::size_t length, std::size_t offset, bool write, bool invalidate, const Queue& queue)
 {
 	cl_int err{CL_SUCCESS};
-	void* bufptr = clEnqueueMapBuffer(m_cl_state->command_queue(), m_cl_memory, true, (write ? (invalidate ? CL_MAP_WRITE_INVALIDATE_REGION : CL_MAP_WRITE) : CL_MAP_READ), offset, length, static_cast<cl_uint>(m_event_cache.size()), (m_event_cache.size() > 0ull ? m_event_cache.data() : nullptr), nullptr, &err);
+	void* bufptr = clEnqueueMapBuffer(m_cl_state->command_queue(queue), m_cl_memory, true, (write ? (invalidate ? CL_MAP_WRITE_INVALIDATE_REGION : CL_MAP_WRITE) : CL_MAP_READ), offset, length, static_cast<cl_uint>(dep_events.size()), dep_events.data(), nullptr, &err);
 	if(err != CL_SUCCESS)
 		throw CLException(err, __LINE__, __FILE__, "[Buffer]: Mapping buffer failed.");
 	return bufptr;
 }
 
-simple_cl::cl::Event simple_cl::cl::Buffer::unmap_buffer(void* bufptr)
+simple_cl::cl::Event simple_cl::cl::Buffer::unmap_buffer(void* bufptr, const Queue& queue)
 {
 	cl_event unmap_event{nullptr};
-	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(), m_cl_memory, bufptr, 0u, nullptr, &unmap_event));
+	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(queue), m_cl_memory, bufptr, 0u, nullptr, queue.events_enabled() ? &unmap_event : nullptr));
 	return Event{unmap_event};
 }
 
@@ -864,6 +2723,235 @@ std::size_t simple_cl::cl::Buffer::size() const noexcept
 	return m_size;
 }
 
+simple_cl::cl::Buffer simple_cl::cl::Buffer::sub_buffer(std::size_t offset, std::size_t size) const
+{
+	// the host pointer option is inherited from the parent and must not be passed again
+	return sub_buffer(offset, size, MemoryFlags{m_flags.device_access, m_flags.host_access, HostPointerOption::None});
+}
+
+simple_cl::cl::Buffer simple_cl::cl::Buffer::sub_buffer(std::size_t offset, std::size_t size, const MemoryFlags& flags) const
+{
+	if(!size)
+		throw std::runtime_error("[Buffer]: Sub-buffer size must not be 0.");
+	if(offset + size > m_size)
+		throw std::out_of_range("[Buffer]: Sub-buffer creation failed. Offset + size out of range.");
+	if(flags.host_pointer_option != HostPointerOption::None)
+		throw std::runtime_error("[Buffer]: Sub-buffers can not have a host pointer option.");
+	std::size_t alignment{sub_buffer_alignment()};
+	if(offset % alignment != 0ull)
+		throw std::runtime_error("[Buffer]: Sub-buffer offset is not a multiple of the device's base address alignment (see sub_buffer_alignment()).");
+
+	// views of views are created relative to the root buffer, OpenCL does not allow nested sub-buffers
+	cl_mem parent{m_parent ? m_parent : m_cl_memory};
+	cl_buffer_region region{m_origin + offset, size};
+	cl_mem_flags clflags{static_cast<cl_mem_flags>(flags.device_access) | static_cast<cl_mem_flags>(flags.host_access)};
+	cl_int err{CL_SUCCESS};
+	cl_mem sub{clCreateSubBuffer(parent, clflags, CL_BUFFER_CREATE_TYPE_REGION, &region, &err)};
+	if(err != CL_SUCCESS)
+		throw CLException(err, __LINE__, __FILE__, "[Buffer]: OpenCL sub-buffer creation failed.");
+	MemoryFlags sub_flags{flags.device_access, flags.host_access, m_flags.host_pointer_option};
+	void* hostptr{m_hostptr ? static_cast<void*>(static_cast<unsigned char*>(m_hostptr) + offset) : nullptr};
+	return Buffer{sub, parent, m_origin + offset, size, sub_flags, m_cl_state, hostptr};
+}
+
+std::size_t simple_cl::cl::Buffer::sub_buffer_alignment() const
+{
+	return context_sub_buffer_alignment(*m_cl_state);
+}
+
+#pragma endregion
+
+#pragma region class BufferPool
+// class BufferPool
+
+simple_cl::cl::BufferPool::State::State(const std::shared_ptr<Context>& clstate, const Config& config) :
+	cl_state{clstate},
+	config{config},
+	bins{},
+	dedicated{},
+	idle_bytes{0ull},
+	stats{},
+	mutex{}
+{
+	if(!cl_state)
+		throw std::runtime_error("[BufferPool]: Invalid context.");
+	if(config.flags.host_pointer_option != HostPointerOption::None)
+		throw std::runtime_error("[BufferPool]: Pooled buffers can not have a host pointer option.");
+	if(config.max_block_size > (std::numeric_limits<std::size_t>::max() >> 1))
+		throw std::runtime_error("[BufferPool]: Maximum block size too large.");
+	// block offsets into slabs are multiples of the block size, so power of two sizes of at least the alignment are valid sub-buffer offsets
+	this->config.min_block_size = util::next_power_of_two(std::max(config.min_block_size, context_sub_buffer_alignment(*cl_state)));
+	this->config.max_block_size = std::max(util::next_power_of_two(config.max_block_size), this->config.min_block_size);
+	for(std::size_t block_size{this->config.min_block_size}; block_size <= this->config.max_block_size; block_size <<= 1)
+		bins.push_back(Bin{block_size, {}, {}});
+}
+
+void simple_cl::cl::BufferPool::State::add_slab(Bin& bin)
+{
+	std::size_t num_blocks{std::max(config.slab_size / bin.block_size, std::size_t{1ull})};
+	std::unique_ptr<Slab> slab{new Slab{Buffer{num_blocks * bin.block_size, config.flags, cl_state}, bin.block_size, num_blocks, {}}};
+	slab->blocks.reserve(num_blocks);
+	std::size_t size_class{static_cast<std::size_t>(&bin - bins.data())};
+	for(std::size_t i{0ull}; i < num_blocks; ++i)
+		slab->blocks.push_back(Block{slab.get(), i * bin.block_size, size_class, nullptr});
+	// capacity for all blocks of the bin, so release() never reallocates
+	bin.free_blocks.reserve(bin.free_blocks.size() + (bin.slabs.size() + 1ull) * num_blocks);
+	bin.slabs.reserve(bin.slabs.size() + 1ull);
+	// lowest offsets are handed out first
+	for(std::size_t i{num_blocks}; i > 0ull; --i)
+		bin.free_blocks.push_back(&slab->blocks[i - 1ull]);
+	idle_bytes += slab->memory.size();
+	++stats.buffers_created;
+	stats.reserved_bytes += slab->memory.size();
+	bin.slabs.push_back(std::move(slab));
+}
+
+void simple_cl::cl::BufferPool::State::release(Block* block, std::size_t size) noexcept
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	--stats.live_allocations;
+	stats.requested_bytes -= size;
+	Slab* slab{block->slab};
+	if(block->size_class == constants::BUFFER_POOL_OVERSIZE)
+	{
+		stats.used_bytes -= slab->memory.size();
+		stats.reserved_bytes -= slab->memory.size();
+		++stats.buffers_released;
+		dedicated.erase(std::find_if(dedicated.begin(), dedicated.end(), [slab](const std::unique_ptr<Slab>& s) { return s.get() == slab; }));
+		return;
+	}
+	bins[block->size_class].free_blocks.push_back(block);
+	stats.used_bytes -= slab->block_size;
+	if(++slab->num_free == slab->blocks.size())
+	{
+		idle_bytes += slab->memory.size();
+		if(idle_bytes > config.max_idle_bytes)
+			trim_locked(config.max_idle_bytes);
+	}
+}
+
+void simple_cl::cl::BufferPool::State::trim_locked(std::size_t max_idle) noexcept
+{
+	for(auto bin = bins.rbegin(); bin != bins.rend() && idle_bytes > max_idle; ++bin)
+	{
+		for(auto slab = bin->slabs.begin(); slab != bin->slabs.end() && idle_bytes > max_idle;)
+		{
+			if((*slab)->num_free != (*slab)->blocks.size())
+			{
+				++slab;
+				continue;
+			}
+			Slab* idle{slab->get()};
+			bin->free_blocks.erase(std::remove_if(bin->free_blocks.begin(), bin->free_blocks.end(), [idle](const Block* block) { return block->slab == idle; }), bin->free_blocks.end());
+			idle_bytes -= idle->memory.size();
+			stats.reserved_bytes -= idle->memory.size();
+			++stats.buffers_released;
+			slab = bin->slabs.erase(slab);
+		}
+	}
+}
+
+simple_cl::cl::BufferPool::BufferPool(const std::shared_ptr<Context>& clstate, const Config& config) :
+	m_state{std::make_shared<State>(clstate, config)}
+{
+}
+
+simple_cl::cl::BufferPool::Handle simple_cl::cl::BufferPool::allocate(std::size_t size)
+{
+	if(!size)
+		throw std::runtime_error("[BufferPool]: Allocation size must not be 0.");
+	State& state = *m_state;
+	std::lock_guard<std::mutex> lock(state.mutex);
+
+	Block* block{nullptr};
+	if(size > state.config.max_block_size)
+	{
+		std::unique_ptr<Slab> slab{new Slab{Buffer{size, state.config.flags, state.cl_state}, size, 0ull, {}}};
+		slab->blocks.push_back(Block{slab.get(), 0ull, constants::BUFFER_POOL_OVERSIZE, nullptr});
+		block = &slab->blocks.front();
+		state.dedicated.push_back(std::move(slab));
+		++state.stats.buffers_created;
+		state.stats.reserved_bytes += size;
+		state.stats.used_bytes += size;
+	}
+	else
+	{
+		std::size_t block_size{util::next_power_of_two(std::max(size, state.config.min_block_size))};
+		std::size_t size_class{0ull};
+		while((state.config.min_block_size << size_class) < block_size)
+			++size_class;
+		Bin& bin = state.bins[size_class];
+		assert(bin.block_size == block_size);
+		if(bin.free_blocks.empty())
+			state.add_slab(bin);
+		block = bin.free_blocks.back();
+		// views are created on first use only and kept with the block
+		if(!block->view)
+		{
+			block->view.reset(new Buffer{block->slab->memory.sub_buffer(block->offset, block_size)});
+			++state.stats.views_created;
+		}
+		bin.free_blocks.pop_back();
+		if(block->slab->num_free-- == block->slab->blocks.size())
+			state.idle_bytes -= block->slab->memory.size();
+		state.stats.used_bytes += block_size;
+	}
+	++state.stats.allocations;
+	++state.stats.live_allocations;
+	state.stats.requested_bytes += size;
+	return Handle{m_state, block, size};
+}
+
+void simple_cl::cl::BufferPool::trim()
+{
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	m_state->trim_locked(0ull);
+}
+
+simple_cl::cl::BufferPool::Stats simple_cl::cl::BufferPool::stats() const
+{
+	std::lock_guard<std::mutex> lock(m_state->mutex);
+	return m_state->stats;
+}
+
+simple_cl::cl::BufferPool::Handle::Handle(Handle&& other) noexcept :
+	m_state{nullptr},
+	m_block{nullptr},
+	m_size{0ull}
+{
+	std::swap(m_state, other.m_state);
+	std::swap(m_block, other.m_block);
+	std::swap(m_size, other.m_size);
+}
+
+simple_cl::cl::BufferPool::Handle& simple_cl::cl::BufferPool::Handle::operator=(Handle&& other) noexcept
+{
+	if(this == &other)
+		return *this;
+	reset();
+	std::swap(m_state, other.m_state);
+	std::swap(m_block, other.m_block);
+	std::swap(m_size, other.m_size);
+	return *this;
+}
+
+void simple_cl::cl::BufferPool::Handle::reset() noexcept
+{
+	if(!m_block)
+		return;
+	m_state->release(m_block, m_size);
+	m_block = nullptr;
+	m_size = 0ull;
+	m_state.reset();
+}
+
+simple_cl::cl::Buffer& simple_cl::cl::BufferPool::Handle::buffer() const
+{
+	if(!m_block)
+		throw std::runtime_error("[BufferPool]: Access to an empty handle.");
+	// dedicated allocations use their buffer directly
+	return m_block->view ? *m_block->view : m_block->slab->memory;
+}
 #pragma endregion
 
 #pragma region class Image
@@ -871,8 +2959,8 @@ std::size_t simple_cl::cl::Buffer::size() const noexcept
 
 simple_cl::cl::Image::Image(const std::shared_ptr<Context>& clstate, const ImageDesc& image_desc) :
 	m_image{nullptr},
+	m_uid{next_memory_uid()},
 	m_image_desc{image_desc},
-	m_event_cache{},
 	m_cl_state{clstate}
 {
 	m_image_desc.host_ptr = (image_desc.flags.host_pointer_option == HostPointerOption::UseHostPtr || image_desc.flags.host_pointer_option == HostPointerOption::CopyHostPtr) ? image_desc.host_ptr : nullptr;
@@ -905,10 +2993,12 @@ simple_cl::cl::Image::~Image() noexcept
 
 simple_cl::cl::Image::Image(Image&& other) noexcept :
 	m_image{other.m_image},
+	m_uid{other.m_uid},
 	m_image_desc{other.m_image_desc},
-	m_event_cache{}
+	m_cl_state{std::move(other.m_cl_state)}
 {
 	other.m_image = nullptr;
+	other.m_uid = next_memory_uid();
 }
 
 simple_cl::cl::Image& simple_cl::cl::Image::operator=(Image&& other) noexcept
@@ -916,7 +3006,9 @@ simple_cl::cl::Image& simple_cl::cl::Image::operator=(Image&& other) noexcept
 	if(this == &other)
 		return *this;
 
+	std::swap(m_cl_state, other.m_cl_state);
 	std::swap(m_image, other.m_image);
+	std::swap(m_uid, other.m_uid);
 	std::swap(m_image_desc, other.m_image_desc);
 
 	return *this;
@@ -958,7 +3050,7 @@ bool simple_cl::cl::Image::match_format(const HostFormat& format)
 	return true;
 }
 
-simple_cl::cl::Event simple_cl::cl::Image::img_write_mapped(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool invalidate, ChannelDefaultValue default_value)
+simple_cl::cl::Event simple_cl::cl::Image::img_write_mapped(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool invalidate, ChannelDefaultValue default_value, const Queue& queue)
 {
 	if(m_image_desc.flags.host_access == HostAccess::NoAccess || m_image_desc.flags.host_access == HostAccess::ReadOnly)
 		throw std::runtime_error("[Image]: Host is not allowed to write this image.");
@@ -995,12 +3087,12 @@ simple_cl::cl::Event simple_cl::cl::Image::img_write_mapped(const ImageRegion& i
 
 	// map image region
 	cl_int err{CL_SUCCESS};
-	cl_event map_event;
+	cl_event map_event{nullptr};
 	std::size_t row_pitch{0ull};
 	std::size_t slice_pitch{0ull};
 	// cast mapped pointer to uint8_t. This way we are allowed to do byte-wise pointer arithmetic.
 	uint8_t* img_ptr = static_cast<uint8_t*>(clEnqueueMapImage(
-		m_cl_state->command_queue(),
+		m_cl_state->command_queue(queue),
 		m_image,
 		CL_TRUE,
 		(invalidate ? CL_MAP_WRITE_INVALIDATE_REGION : CL_MAP_WRITE),
@@ -1008,8 +3100,8 @@ simple_cl::cl::Event simple_cl::cl::Image::img_write_mapped(const ImageRegion& i
 		&region[0],
 		&row_pitch,
 		&slice_pitch,
-		static_cast<cl_uint>(m_event_cache.size()),
-		(m_event_cache.size() > 0ull ? m_event_cache.data() : nullptr),
+		static_cast<cl_uint>(dep_events.size()),
+		dep_events.data(),
 		nullptr,
 		&err
 	));
@@ -1067,11 +3159,11 @@ simple_cl::cl::Event simple_cl::cl::Image::img_write_mapped(const ImageRegion& i
 		throw std::runtime_error("[Image]: Image write failed. Host format does not match image format.");
 
 	// unmap image and return event
-	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(), m_image, img_ptr, 0ull, nullptr, &map_event));
+	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(queue), m_image, img_ptr, 0ull, nullptr, queue.events_enabled() ? &map_event : nullptr));
 	return Event{map_event};
 }
 
-simple_cl::cl::Event simple_cl::cl::Image::img_write(const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking, ChannelDefaultValue default_value)
+simple_cl::cl::Event simple_cl::cl::Image::img_write(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, const void* data_ptr, bool blocking, ChannelDefaultValue default_value, const Queue& queue)
 {
 	if(m_image_desc.flags.host_access == HostAccess::NoAccess || m_image_desc.flags.host_access == HostAccess::ReadOnly)
 		throw std::runtime_error("[Image]: Host is not allowed to write this image.");
@@ -1111,12 +3203,12 @@ simple_cl::cl::Event simple_cl::cl::Image::img_write(const ImageRegion& img_regi
 		throw std::runtime_error("[Image]: Row pitch must be >= height * host row pitch.");
 
 	// map image region
-	cl_event write_event;
+	cl_event write_event{nullptr};
 	std::size_t row_pitch{0ull};
 	std::size_t slice_pitch{0ull};
 	// cast mapped pointer to uint8_t. This way we are allowed to do byte-wise pointer arithmetic.
 	CL_EX(clEnqueueWriteImage(
-		m_cl_state->command_queue(),
+		m_cl_state->command_queue(queue),
 		m_image,
 		blocking ? CL_TRUE : CL_FALSE,
 		&origin[0],
@@ -1124,16 +3216,16 @@ simple_cl::cl::Event simple_cl::cl::Image::img_write(const ImageRegion& img_regi
 		host_row_pitch,
 		m_image_desc.type != ImageType::Image2D ? host_slice_pitch : 0,
 		data_ptr,
-		static_cast<cl_uint>(m_event_cache.size()),
-		(m_event_cache.size() > 0ull ? m_event_cache.data() : nullptr),
-		&write_event
+		static_cast<cl_uint>(dep_events.size()),
+		dep_events.data(),
+		queue.events_enabled() ? &write_event : nullptr
 	));	
 
 	// unmap image and return event
 	return Event{write_event};
 }
 
-simple_cl::cl::Event simple_cl::cl::Image::img_read_mapped(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, ChannelDefaultValue default_value)
+simple_cl::cl::Event simple_cl::cl::Image::img_read_mapped(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, void* data_ptr, ChannelDefaultValue default_value, const Queue& queue)
 {
 	if(m_image_desc.flags.host_access == HostAccess::NoAccess || m_image_desc.flags.host_access == HostAccess::WriteOnly)
 		throw std::runtime_error("[Image]: Host is not allowed to read this image.");
@@ -1170,12 +3262,12 @@ simple_cl::cl::Event simple_cl::cl::Image::img_read_mapped(const ImageRegion& im
 
 	// map image region
 	cl_int err{CL_SUCCESS};
-	cl_event map_event;
+	cl_event map_event{nullptr};
 	std::size_t row_pitch{0ull};
 	std::size_t slice_pitch{0ull};
 	// cast mapped pointer to uint8_t. This way we are allowed to do byte-wise pointer arithmetic.
 	uint8_t* img_ptr = static_cast<uint8_t*>(clEnqueueMapImage(
-		m_cl_state->command_queue(),
+		m_cl_state->command_queue(queue),
 		m_image,
 		CL_TRUE,
 		CL_MAP_READ,
@@ -1183,8 +3275,8 @@ simple_cl::cl::Event simple_cl::cl::Image::img_read_mapped(const ImageRegion& im
 		&region[0],
 		&row_pitch,
 		&slice_pitch,
-		static_cast<cl_uint>(m_event_cache.size()),
-		(m_event_cache.size() > 0ull ? m_event_cache.data() : nullptr),
+		static_cast<cl_uint>(dep_events.size()),
+		dep_events.data(),
 		nullptr,
 		&err
 	));
@@ -1242,11 +3334,11 @@ simple_cl::cl::Event simple_cl::cl::Image::img_read_mapped(const ImageRegion& im
 		throw std::runtime_error("[Image]: Image read failed. Host format does not match image format.");
 
 	// unmap image and return event
-	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(), m_image, img_ptr, 0ull, nullptr, &map_event));
+	CL_EX(clEnqueueUnmapMemObject(m_cl_state->command_queue(queue), m_image, img_ptr, 0ull, nullptr, queue.events_enabled() ? &map_event : nullptr));
 	return Event{map_event};
 }
 
-simple_cl::cl::Event simple_cl::cl::Image::img_read(const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking, ChannelDefaultValue default_value)
+simple_cl::cl::Event simple_cl::cl::Image::img_read(const EventList& dep_events, const ImageRegion& img_region, const HostFormat& format, void* data_ptr, bool blocking, ChannelDefaultValue default_value, const Queue& queue)
 {
 	if(m_image_desc.flags.host_access == HostAccess::NoAccess || m_image_desc.flags.host_access == HostAccess::WriteOnly)
 		throw std::runtime_error("[Image]: Host is not allowed to read this image.");
@@ -1286,12 +3378,12 @@ simple_cl::cl::Event simple_cl::cl::Image::img_read(const ImageRegion& img_regio
 		throw std::runtime_error("[Image]: Row pitch must be >= height * host row pitch.");
 
 	// map image region
-	cl_event read_event;
+	cl_event read_event{nullptr};
 	std::size_t row_pitch{0ull};
 	std::size_t slice_pitch{0ull};
 	// cast mapped pointer to uint8_t. This way we are allowed to do byte-wise pointer arithmetic.
 	CL_EX(clEnqueueReadImage(
-		m_cl_state->command_queue(),
+		m_cl_state->command_queue(queue),
 		m_image,
 		blocking ? CL_TRUE : CL_FALSE,
 		&origin[0],
@@ -1299,15 +3391,15 @@ simple_cl::cl::Event simple_cl::cl::Image::img_read(const ImageRegion& img_regio
 		host_row_pitch,
 		host_slice_pitch,
 		data_ptr,
-		static_cast<cl_uint>(m_event_cache.size()),
-		(m_event_cache.size() > 0ull ? m_event_cache.data() : nullptr),
-		&read_event
+		static_cast<cl_uint>(dep_events.size()),
+		dep_events.data(),
+		queue.events_enabled() ? &read_event : nullptr
 	));
 
 	return Event{read_event};
 }
 
-simple_cl::cl::Event simple_cl::cl::Image::img_fill(const FillColor& color, const ImageRegion& img_region)
+simple_cl::cl::Event simple_cl::cl::Image::img_fill(const EventList& dep_events, const FillColor& color, const ImageRegion& img_region, const Queue& queue)
 {
 	if(m_image_desc.flags.host_access == HostAccess::NoAccess || m_image_desc.flags.host_access == HostAccess::ReadOnly)
 		throw std::runtime_error("[Image]: Host is not allowed to fill this image.");
@@ -1402,14 +3494,14 @@ simple_cl::cl::Event simple_cl::cl::Image::img_fill(const FillColor& color, cons
 	// API call
 	cl_event fill_event{nullptr};
 	CL_EX(clEnqueueFillImage(
-		m_cl_state->command_queue(),
+		m_cl_state->command_queue(queue),
 		m_image,
 		static_cast<const void*>(&color_buffer[0]),
 		&origin[0],
 		&region[0],
-		static_cast<cl_uint>(m_event_cache.size()),
-		(m_event_cache.size() > 0ull ? m_event_cache.data() : nullptr),
-		&fill_event)
+		static_cast<cl_uint>(dep_events.size()),
+		dep_events.data(),
+		queue.events_enabled() ? &fill_event : nullptr)
 	);
 	return Event{fill_event};
 }